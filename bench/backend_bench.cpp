@@ -0,0 +1,198 @@
+// End-to-end throughput benchmark for the Backend command pipeline, without the CLI.
+// Client threads drive Backend::getBackend() with frontendMove, getBoard and getGame futures
+// (plus callEngine / newGame to keep games going) and record latency from call to future.get().
+//
+// Build from the repository root:
+//   g++ -std=c++20 -O2 -pthread bench/backend_bench.cpp -o backend_bench
+// Usage:
+//   ./backend_bench [--seconds <s>] [--max-clients <n>] [--depth <futures in flight per client>] [--quiet]
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/backend.h"
+#include "../src/Metrics.h"
+
+namespace
+{
+  using namespace GosFrontline;
+  using Clock = std::chrono::steady_clock;
+
+  enum Kind
+  {
+    Move = 0,
+    GetBoard,
+    GetGame,
+    Kinds
+  };
+  const char *kind_names[Kinds] = {"frontendMove", "getBoard", "getGame"};
+
+  const int max_steps = 150; // Start a new game before a 15x15 board gets crowded
+
+  struct Totals
+  {
+    LatencyHistogram latency[Kinds];
+    LatencyHistogram all;
+    std::atomic<long long> requests{0}, moves{0};
+  };
+
+  struct Pending
+  {
+    Kind kind;
+    Clock::time_point start;
+    decltype(std::declval<Backend &>().frontendMove(0, 0)) move;
+    decltype(std::declval<Backend &>().getBoard()) board;
+    decltype(std::declval<Backend &>().getGame()) game;
+  };
+
+  /// @brief One client: keeps @p depth requests in flight until @p stop is set.
+  ///        Mix: half moves, a third board reads, the rest full game reads. A client whose move
+  ///        succeeds asks the engine to reply, or starts a new game once the board fills up.
+  void client(Backend &backend, Totals &totals, int depth, int seed, const std::atomic<bool> &stop)
+  {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> coord(0, static_cast<int>(standardSize) - 1), pick(0, 5);
+    std::deque<Pending> in_flight;
+
+    auto issue = [&]()
+    {
+      Pending p;
+      int choice = pick(gen);
+      p.kind = choice < 3 ? Move : (choice < 5 ? GetBoard : GetGame);
+      p.start = Clock::now();
+      if (p.kind == Move)
+        p.move = backend.frontendMove(coord(gen), coord(gen));
+      else if (p.kind == GetBoard)
+        p.board = backend.getBoard();
+      else
+        p.game = backend.getGame();
+      in_flight.push_back(std::move(p));
+    };
+
+    auto harvest = [&]()
+    {
+      Pending p = std::move(in_flight.front());
+      in_flight.pop_front();
+      if (p.kind == Move)
+      {
+        auto [reply, step] = p.move.get();
+        if (reply == MoveReply::Success and step < max_steps)
+        {
+          backend.callEngine().get();
+          totals.moves.fetch_add(2, std::memory_order_relaxed);
+        }
+        else if (reply == MoveReply::Success or reply == MoveReply::Win)
+        {
+          backend.newGame(standardSize, standardSize);
+          totals.moves.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      else if (p.kind == GetBoard)
+      {
+        p.board.get();
+      }
+      else
+      {
+        p.game.get();
+      }
+      auto elapsed = Clock::now() - p.start;
+      totals.latency[p.kind].record(elapsed);
+      totals.all.record(elapsed);
+      totals.requests.fetch_add(1, std::memory_order_relaxed);
+    };
+
+    while (not stop.load(std::memory_order_relaxed))
+    {
+      while (static_cast<int>(in_flight.size()) < depth)
+        issue();
+      harvest();
+    }
+    while (not in_flight.empty())
+      harvest();
+  }
+
+  void printRow(const std::string &label, const LatencySummary &s, double seconds)
+  {
+    std::cout << std::left << std::setw(16) << label << std::right << std::fixed << std::setprecision(0)
+              << std::setw(12) << s.count / seconds << std::setprecision(1)
+              << std::setw(10) << s.p50_ns / 1000.0 << std::setw(10) << s.p99_ns / 1000.0
+              << std::setw(10) << s.p999_ns / 1000.0 << std::setw(10) << s.max_ns / 1000.0 << std::endl;
+  }
+} // namespace
+
+int main(int argc, char **argv)
+{
+  double seconds = 2.0;
+  int max_clients = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+  int depth = 1;
+  bool quiet = false;
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--seconds") == 0 and i + 1 < argc)
+      seconds = std::atof(argv[++i]);
+    else if (std::strcmp(argv[i], "--max-clients") == 0 and i + 1 < argc)
+      max_clients = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "--depth") == 0 and i + 1 < argc)
+      depth = std::max(1, std::atoi(argv[++i]));
+    else if (std::strcmp(argv[i], "--quiet") == 0)
+      quiet = true;
+    else
+    {
+      std::cerr << "Usage: " << argv[0] << " [--seconds <s>] [--max-clients <n>] [--depth <n>] [--quiet]" << std::endl;
+      return 1;
+    }
+  }
+
+  auto service = std::make_shared<LogService>("backend_bench");
+  std::shared_ptr<Logger> log = service->channel("Backend");
+  Backend &backend = Backend::getBackend();
+  backend.setLogger(log);
+  if (quiet)
+  {
+    for (const char *channel : {"Backend", "Engine", "IO", "Metrics"})
+      service->setEnabled(channel, MessageType::INFO, false);
+  }
+  std::cout << "Logging to " << service->getFileName() << (quiet ? " (INFO off)" : "") << std::endl;
+
+  for (int clients = 1; clients <= max_clients; clients *= 2)
+  {
+    std::thread runner([&backend]()
+                       { backend.run(); });
+    backend.newGame(standardSize, standardSize);
+
+    Totals totals;
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> threads;
+    auto begin = Clock::now();
+    for (int c = 0; c < clients; c++)
+      threads.emplace_back(client, std::ref(backend), std::ref(totals), depth, 1000 + c, std::cref(stop));
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop.store(true);
+    for (auto &t : threads)
+      t.join();
+    double elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    backend.quit();
+    runner.join();
+
+    std::cout << "\n"
+              << clients << " client(s), " << depth << " in flight each: "
+              << std::fixed << std::setprecision(0) << totals.requests.load() / elapsed << " requests/s, "
+              << totals.moves.load() / elapsed << " moves/s\n";
+    std::cout << std::left << std::setw(16) << "request" << std::right << std::setw(12) << "per sec"
+              << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(10) << "p999 us" << std::setw(10) << "max us" << std::endl;
+    for (int k = 0; k < Kinds; k++)
+      printRow(kind_names[k], totals.latency[k].summary(), elapsed);
+    printRow("all", totals.all.summary(), elapsed);
+  }
+  return 0;
+}
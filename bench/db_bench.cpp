@@ -0,0 +1,150 @@
+// Scan throughput over a game archive: GameArchive::load (seek, read and decode each game) against
+// GameDatabase views on 1, 2, 4, ... threads. Every pass computes the same statistics (result
+// counts, total moves and a checksum of all squares played), so the numbers are comparable.
+// Without --archive, --games random games are written to a temporary archive first.
+//
+// Build from the repository root:
+//   g++ -std=c++20 -O2 -pthread bench/db_bench.cpp -o db_bench
+// Usage:
+//   ./db_bench [--archive <file.gfla>] [--games <n>] [--max-threads <n>] [--verify]
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "../src/GameDatabase.h"
+
+namespace
+{
+  using namespace GosFrontline;
+  using Clock = std::chrono::steady_clock;
+
+  struct Stats
+  {
+    std::array<std::atomic<long long>, 4> results{};
+    std::atomic<long long> moves{0};
+    std::atomic<unsigned long long> checksum{0};
+
+    void add(ArchiveResult result, long long game_moves, unsigned long long game_sum)
+    {
+      results[static_cast<int>(result) & 3].fetch_add(1, std::memory_order_relaxed);
+      moves.fetch_add(game_moves, std::memory_order_relaxed);
+      checksum.fetch_add(game_sum, std::memory_order_relaxed);
+    }
+  };
+
+  void buildArchive(const std::filesystem::path &path, int count)
+  {
+    std::mt19937 gen(20240701);
+    std::uniform_int_distribution<int> coord(0, static_cast<int>(standardSize) - 1), length(20, 150);
+    GameArchive::Writer writer(path);
+    for (int g = 0; g < count; g++)
+    {
+      Gaming game(standardSize, standardSize, PieceType::None);
+      int target = length(gen);
+      while (game.movesMade() < target)
+      {
+        int r = coord(gen), c = coord(gen);
+        if (game.isEmpty(r, c) and game.makeMove(r, c) and game.checkCurrentWin(r, c) != PieceType::None)
+          break;
+      }
+      writer.add(game);
+    }
+  }
+
+  void printRow(const std::string &label, double seconds, const Stats &stats, size_t games, size_t bytes)
+  {
+    std::cout << std::left << std::setw(22) << label << std::right << std::fixed << std::setprecision(0)
+              << std::setw(14) << games / seconds << std::setw(14) << stats.moves.load() / seconds
+              << std::setw(10) << std::setprecision(1) << bytes / seconds / 1e6
+              << std::setw(20) << stats.checksum.load() << std::endl;
+  }
+} // namespace
+
+int main(int argc, char **argv)
+{
+  std::filesystem::path archive_path;
+  int count = 200000;
+  unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+  bool verify = false;
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--archive") == 0 and i + 1 < argc)
+      archive_path = argv[++i];
+    else if (std::strcmp(argv[i], "--games") == 0 and i + 1 < argc)
+      count = std::max(1, std::atoi(argv[++i]));
+    else if (std::strcmp(argv[i], "--max-threads") == 0 and i + 1 < argc)
+      max_threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+    else if (std::strcmp(argv[i], "--verify") == 0)
+      verify = true;
+    else
+    {
+      std::cerr << "Usage: " << argv[0] << " [--archive <file.gfla>] [--games <n>] [--max-threads <n>] [--verify]" << std::endl;
+      return 1;
+    }
+  }
+
+  bool temporary = archive_path.empty();
+  if (temporary)
+  {
+    archive_path = std::filesystem::temp_directory_path() / ("db_bench_" + std::to_string(::getpid()) + GameArchive::extension);
+    auto begin = Clock::now();
+    buildArchive(archive_path, count);
+    std::cout << "Wrote " << count << " games to " << archive_path.string() << " in " << std::fixed << std::setprecision(2)
+              << std::chrono::duration<double>(Clock::now() - begin).count() << " s" << std::endl;
+  }
+
+  {
+    size_t bytes = std::filesystem::file_size(archive_path);
+    std::cout << std::left << std::setw(22) << "reader" << std::right << std::setw(14) << "games/s" << std::setw(14) << "moves/s"
+              << std::setw(10) << "MB/s" << std::setw(20) << "checksum" << std::endl;
+
+    {
+      Stats stats;
+      auto begin = Clock::now();
+      GameArchive archive(archive_path);
+      for (size_t i = 0; i < archive.size(); i++)
+      {
+        Gaming game = archive.load(i);
+        unsigned long long sum = 0;
+        for (const auto &move : game.getSequence())
+          sum += static_cast<unsigned long long>(std::get<0>(move)) * game.col_count() + std::get<1>(move);
+        stats.add(archive.entry(i).result, game.movesMade(), sum);
+      }
+      printRow("GameArchive::load", std::chrono::duration<double>(Clock::now() - begin).count(), stats, archive.size(), bytes);
+    }
+
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+    {
+      Stats stats;
+      auto begin = Clock::now();
+      GameDatabase db(archive_path);
+      db.forEach([&stats](const GameView &view)
+                 {
+                   unsigned long long sum = 0;
+                   for (const StoredMove &move : view.moves)
+                     sum += static_cast<unsigned long long>(move.row) * view.cols + move.col;
+                   stats.add(view.entry->result, static_cast<long long>(view.moves.size()), sum); },
+                 threads, verify);
+      printRow("GameDatabase x" + std::to_string(threads), std::chrono::duration<double>(Clock::now() - begin).count(), stats, db.size(), bytes);
+      if (threads == max_threads)
+      {
+        std::cout << "results: " << stats.results[0] << " unfinished, " << stats.results[1] << " Sente, "
+                  << stats.results[2] << " Gote, " << stats.results[3] << " draws" << std::endl;
+      }
+    }
+  }
+
+  if (temporary)
+    std::filesystem::remove(archive_path);
+  return 0;
+}
@@ -0,0 +1,292 @@
+// Microbenchmarks for the Gaming rule primitives, run over a fixed corpus of mid-game positions.
+// Results go to stdout as a table and, with --json, as machine-readable JSON laid out like
+// Google Benchmark's output, so two runs can be diffed to catch regressions.
+//
+// Build from the repository root:
+//   g++ -std=c++20 -O2 bench/gaming_bench.cpp -o gaming_bench
+// Usage:
+//   ./gaming_bench [--json <file|->] [--min-time <ms>] [--filter <substring>]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/Gaming.h"
+
+namespace
+{
+  using namespace GosFrontline;
+  using Clock = std::chrono::steady_clock;
+  using Square = std::pair<int, int>;
+
+  volatile long long sink; // Keeps results alive so the optimiser cannot drop the work
+
+  struct Position
+  {
+    Gaming game;
+    std::vector<Square> stones, empties;
+  };
+
+  /// @brief Deterministic self-play: each move lands within two squares of an existing stone,
+  ///        Sente never plays a forbidden move, and nobody completes five. Positions are taken
+  ///        with Sente to move so violation() and makeMove() do their full work.
+  std::vector<Position> buildCorpus(int games)
+  {
+    std::mt19937 gen(20240501);
+    std::vector<Position> corpus;
+    const int targets[] = {20, 30, 40, 50, 60};
+    for (int g = 0; g < games; g++)
+    {
+      Gaming game(standardSize, standardSize, PieceType::None);
+      game.makeMove(7, 7);
+      int target = targets[g % 5];
+      int stuck = 0;
+      while (game.movesMade() < target and stuck < 1000)
+      {
+        const auto &moves = game.getSequence();
+        const auto &anchor = moves[std::uniform_int_distribution<size_t>(0, moves.size() - 1)(gen)];
+        int row = std::get<0>(anchor) + std::uniform_int_distribution<int>(-2, 2)(gen);
+        int col = std::get<1>(anchor) + std::uniform_int_distribution<int>(-2, 2)(gen);
+        if (not game.isValidCoord(row, col) or not game.isEmpty(row, col) or not game.makeMove(row, col))
+        {
+          stuck++;
+          continue;
+        }
+        if (game.checkCurrentWin(row, col) != PieceType::None)
+        {
+          game.undo();
+          stuck++;
+        }
+      }
+
+      Position position{game, {}, {}};
+      for (int r = 0; r < static_cast<int>(game.row_count()); r++)
+      {
+        for (int c = 0; c < static_cast<int>(game.col_count()); c++)
+        {
+          (game.isEmpty(r, c) ? position.empties : position.stones).emplace_back(r, c);
+        }
+      }
+      corpus.push_back(std::move(position));
+    }
+    return corpus;
+  }
+
+  struct Result
+  {
+    std::string name;
+    long long iterations;   // Operations timed in the best repetition
+    double ns_per_op;       // Median over repetitions
+    double min_ns, max_ns;
+  };
+
+  /// @brief Time @p pass, which performs and returns some number of operations over the corpus.
+  ///        Each repetition repeats the pass until @p min_time has elapsed; the median wins.
+  Result measure(const std::string &name, std::chrono::milliseconds min_time, const std::function<long long()> &pass)
+  {
+    const int repetitions = 5;
+    pass(); // Warm caches and branch predictors
+    std::vector<double> samples;
+    long long best_ops = 0;
+    for (int rep = 0; rep < repetitions; rep++)
+    {
+      long long ops = 0;
+      auto begin = Clock::now();
+      auto end = begin;
+      do
+      {
+        ops += pass();
+        end = Clock::now();
+      } while (end - begin < min_time / repetitions);
+      samples.push_back(std::chrono::duration<double, std::nano>(end - begin).count() / ops);
+      best_ops = std::max(best_ops, ops);
+    }
+    std::sort(samples.begin(), samples.end());
+    return Result{name, best_ops, samples[samples.size() / 2], samples.front(), samples.back()};
+  }
+
+  std::string jsonEscape(const std::string &text)
+  {
+    std::string out;
+    for (char c : text)
+    {
+      if (c == '"' or c == '\\')
+        out += '\\';
+      out += c;
+    }
+    return out;
+  }
+
+  void writeJson(std::ostream &out, const std::vector<Result> &results, size_t positions)
+  {
+    out << "{\n  \"context\": {\n"
+        << "    \"date\": " << std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count() << ",\n"
+        << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+        << "    \"corpus_positions\": " << positions << "\n  },\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+      const Result &r = results[i];
+      out << "    {\"name\": \"" << jsonEscape(r.name) << "\", \"iterations\": " << r.iterations
+          << std::fixed << std::setprecision(3)
+          << ", \"real_time\": " << r.ns_per_op << ", \"min_time\": " << r.min_ns << ", \"max_time\": " << r.max_ns
+          << ", \"time_unit\": \"ns\"}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+  }
+} // namespace
+
+int main(int argc, char **argv)
+{
+  std::string json_path, filter;
+  std::chrono::milliseconds min_time(500);
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--json") == 0 and i + 1 < argc)
+      json_path = argv[++i];
+    else if (std::strcmp(argv[i], "--min-time") == 0 and i + 1 < argc)
+      min_time = std::chrono::milliseconds(std::atoi(argv[++i]));
+    else if (std::strcmp(argv[i], "--filter") == 0 and i + 1 < argc)
+      filter = argv[++i];
+    else
+    {
+      std::cerr << "Usage: " << argv[0] << " [--json <file|->] [--min-time <ms>] [--filter <substring>]" << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<Position> corpus = buildCorpus(40);
+
+  std::vector<std::pair<std::string, std::function<long long()>>> benchmarks = {
+      // directionCount and openDegree are private; these time them through their public callers,
+      // each of which runs the primitive once per direction.
+      {"Gaming/countLength", [&corpus]()
+       {
+         long long ops = 0, acc = 0;
+         for (const auto &p : corpus)
+           for (const auto &[r, c] : p.stones)
+           {
+             acc += p.game.countLength(r, c, 3);
+             ops++;
+           }
+         sink = acc;
+         return ops;
+       }},
+      {"Gaming/countLiveThree", [&corpus]()
+       {
+         long long ops = 0, acc = 0;
+         for (const auto &p : corpus)
+           for (const auto &[r, c] : p.stones)
+           {
+             acc += p.game.countLiveThree(r, c);
+             ops++;
+           }
+         sink = acc;
+         return ops;
+       }},
+      {"Gaming/maxConnect", [&corpus]()
+       {
+         long long ops = 0, acc = 0;
+         for (const auto &p : corpus)
+           for (const auto &[r, c] : p.stones)
+           {
+             acc += p.game.maxConnect(r, c);
+             ops++;
+           }
+         sink = acc;
+         return ops;
+       }},
+      {"Gaming/violation", [&corpus]()
+       {
+         long long ops = 0, acc = 0;
+         for (auto &p : corpus)
+           for (const auto &[r, c] : p.empties)
+           {
+             acc += p.game.violation(r, c);
+             ops++;
+           }
+         sink = acc;
+         return ops;
+       }},
+      {"Gaming/checkCurrentWin", [&corpus]()
+       {
+         long long ops = 0, acc = 0;
+         for (const auto &p : corpus)
+           for (const auto &[r, c] : p.stones)
+           {
+             acc += static_cast<int>(p.game.checkCurrentWin(r, c));
+             ops++;
+           }
+         sink = acc;
+         return ops;
+       }},
+      {"Gaming/checkWinFull", [&corpus]()
+       {
+         long long acc = 0;
+         for (const auto &p : corpus)
+           acc += static_cast<int>(p.game.checkWinFull());
+         sink = acc;
+         return static_cast<long long>(corpus.size());
+       }},
+      {"Gaming/makeMove+undo", [&corpus]()
+       {
+         long long ops = 0, acc = 0;
+         for (auto &p : corpus)
+           for (const auto &[r, c] : p.empties)
+           {
+             if (p.game.makeMove(r, c))
+               acc += p.game.undo();
+             ops++;
+           }
+         sink = acc;
+         return ops;
+       }},
+      {"Board/copy", [&corpus]()
+       {
+         long long acc = 0;
+         for (const auto &p : corpus)
+         {
+           std::vector<std::vector<PieceType>> copy = p.game.getBoard();
+           acc += static_cast<long long>(copy.size());
+         }
+         sink = acc;
+         return static_cast<long long>(corpus.size());
+       }},
+  };
+
+  std::vector<Result> results;
+  std::cout << std::left << std::setw(28) << "benchmark" << std::setw(14) << "ns/op" << std::setw(14) << "min" << std::setw(14) << "max" << "ops" << std::endl;
+  for (const auto &[name, pass] : benchmarks)
+  {
+    if (not filter.empty() and name.find(filter) == std::string::npos)
+      continue;
+    Result r = measure(name, min_time, pass);
+    std::cout << std::left << std::fixed << std::setprecision(1) << std::setw(28) << r.name << std::setw(14) << r.ns_per_op
+              << std::setw(14) << r.min_ns << std::setw(14) << r.max_ns << r.iterations << std::endl;
+    results.push_back(r);
+  }
+
+  if (json_path == "-")
+  {
+    writeJson(std::cout, results, corpus.size());
+  }
+  else if (not json_path.empty())
+  {
+    std::ofstream out(json_path);
+    if (not out.is_open())
+    {
+      std::cerr << "Could not write " << json_path << std::endl;
+      return 1;
+    }
+    writeJson(out, results, corpus.size());
+  }
+  return 0;
+}
@@ -0,0 +1,253 @@
+// Load-time benchmark for saved games: the regex .gfl loader that Backend::boardLoader used to run,
+// against TextSave::decode (single pass over a string_view) and BinarySave::decode.
+// By default a synthetic archive of random legal games is generated in memory; with --dir every
+// .gfl and .gflb file in a directory is loaded instead. Each parser is timed over the whole
+// archive, best of five passes; TextSave is first checked to return the same games as the regex loader,
+// and the same game again when move fields are separated by tabs.
+//
+// Build from the repository root:
+//   g++ -std=c++20 -O2 bench/load_bench.cpp -o load_bench
+// Usage:
+//   ./load_bench [--games <n>] [--dir <saved_games>] [--skip-legacy]
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/SaveFormat.h"
+
+namespace
+{
+  using namespace GosFrontline;
+  using Clock = std::chrono::steady_clock;
+
+  /// @brief The regex loader as it stood before TextSave, kept here as the baseline.
+  Gaming legacyLoad(std::string result)
+  {
+    result.erase(std::remove(result.begin(), result.end(), '\r'), result.end());
+    std::smatch match_cache;
+    std::regex sente_r(R"(Sente:\s*(.*))");
+    std::regex gote_r(R"(^Gote:\s*(.*)$)", std::regex_constants::ECMAScript | std::regex_constants::multiline);
+    std::regex engine_r(R"(Engine Status:\s*(Sente|Gote|Disabled))");
+    std::regex board_params_r(R"(^Board Parameters:\s*(\d+)\*(\d+)$)", std::regex_constants::ECMAScript | std::regex_constants::multiline);
+
+    std::regex_search(result, match_cache, gote_r);
+    std::string gote = match_cache[1];
+    std::regex_search(result, match_cache, sente_r);
+    std::string sente = match_cache[1];
+    std::regex_search(result, match_cache, engine_r);
+    PieceType engine_status = (match_cache[1] == "Disabled") ? PieceType::None : ((match_cache[1] == "Sente") ? PieceType::Sente : PieceType::Gote);
+    std::regex_search(result, match_cache, board_params_r);
+    int rows = std::stoi(match_cache[1]);
+    int cols = std::stoi(match_cache[2]);
+
+    std::stringstream regex_processor("");
+    regex_processor << "^(?:[ @O]){" << cols << "}$";
+    std::regex board_r(regex_processor.str(), std::regex_constants::ECMAScript | std::regex_constants::multiline),
+        move_r(R"((\d+)\s+(\d+)\s+(Sente|Gote)\s*\n)");
+
+    std::vector<std::vector<PieceType>> board(rows, std::vector<PieceType>(cols, PieceType::None));
+    int row = 0;
+    int stone_count = 0;
+    for (std::sregex_iterator i(result.begin(), result.end(), board_r); i != std::sregex_iterator() and row < rows; ++i, ++row)
+    {
+      std::string line = (*i)[0].str();
+      for (int col = 0; col < cols and col < static_cast<int>(line.size()); ++col)
+      {
+        if (line[col] == ' ')
+          continue;
+        board[row][col] = (line[col] == '@') ? PieceType::Sente : PieceType::Gote;
+        stone_count++;
+      }
+    }
+
+    std::vector<std::tuple<int, int, PieceType>> sequence;
+    for (std::sregex_iterator i(result.begin(), result.end(), move_r); i != std::sregex_iterator(); ++i)
+      sequence.emplace_back(std::stoi((*i)[1].str()), std::stoi((*i)[2].str()), ((*i)[3].str() == "Sente") ? PieceType::Sente : PieceType::Gote);
+    if (stone_count != static_cast<int>(sequence.size()))
+      throw std::runtime_error("Invalid board: Moving sequence did not agree with board on stone count.");
+    return Gaming(rows, cols, board, sequence, sente, gote, engine_status);
+  }
+
+  /// @brief Random legal games of 10 to 120 moves that stop short of a win.
+  std::vector<Gaming> buildGames(int count)
+  {
+    std::mt19937 gen(20240601);
+    std::uniform_int_distribution<int> coord(0, static_cast<int>(standardSize) - 1), length(10, 120);
+    std::vector<Gaming> games;
+    for (int g = 0; g < count; g++)
+    {
+      Gaming game(standardSize, standardSize, PieceType::None);
+      game.setSenteName("Player " + std::to_string(g));
+      int target = length(gen), stuck = 0;
+      while (game.movesMade() < target and stuck < 1000)
+      {
+        int r = coord(gen), c = coord(gen);
+        if (not game.isEmpty(r, c) or not game.makeMove(r, c))
+        {
+          stuck++;
+          continue;
+        }
+        if (game.checkCurrentWin(r, c) != PieceType::None)
+        {
+          game.undo();
+          stuck++;
+        }
+      }
+      game.setEngineStatus(g % 2 ? PieceType::Gote : PieceType::None);
+      games.push_back(std::move(game));
+    }
+    return games;
+  }
+
+  /// @brief @p file with the fields of every move line separated by tabs, which the regex loader's \\s+ accepted.
+  std::string tabSeparated(const std::string &file)
+  {
+    std::string out;
+    std::istringstream in(file);
+    for (std::string line; std::getline(in, line);)
+    {
+      bool move = not line.empty() and std::isdigit(static_cast<unsigned char>(line[0])) and
+                  (line.find(" Sente") != std::string::npos or line.find(" Gote") != std::string::npos);
+      if (move)
+        std::replace(line.begin(), line.end(), ' ', '\t');
+      out += line + '\n';
+    }
+    return out;
+  }
+
+  std::string readFile(const std::filesystem::path &path)
+  {
+    std::string data(std::filesystem::file_size(path), '\0');
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    in.read(data.data(), static_cast<std::streamsize>(data.size()));
+    return data;
+  }
+
+  /// @brief Best of five passes of @p load over every file in @p archive; returns seconds.
+  double timeLoads(const std::vector<std::string> &archive, const std::function<Gaming(const std::string &)> &load, long long &moves)
+  {
+    double best = 1e30;
+    for (int rep = 0; rep < 5; rep++)
+    {
+      moves = 0;
+      auto begin = Clock::now();
+      for (const auto &file : archive)
+        moves += load(file).movesMade();
+      best = std::min(best, std::chrono::duration<double>(Clock::now() - begin).count());
+    }
+    return best;
+  }
+
+  void printRow(const std::string &label, const std::vector<std::string> &archive, double seconds, long long moves)
+  {
+    size_t bytes = 0;
+    for (const auto &file : archive)
+      bytes += file.size();
+    std::cout << std::left << std::setw(20) << label << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << seconds * 1e6 / archive.size() << std::setw(14) << std::setprecision(0) << archive.size() / seconds
+              << std::setw(14) << moves / seconds << std::setw(12) << std::setprecision(1) << bytes / seconds / 1e6
+              << std::setw(12) << bytes / 1024.0 << std::endl;
+  }
+} // namespace
+
+int main(int argc, char **argv)
+{
+  int count = 2000;
+  std::string dir;
+  bool legacy = true;
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--games") == 0 and i + 1 < argc)
+      count = std::max(1, std::atoi(argv[++i]));
+    else if (std::strcmp(argv[i], "--dir") == 0 and i + 1 < argc)
+      dir = argv[++i];
+    else if (std::strcmp(argv[i], "--skip-legacy") == 0)
+      legacy = false;
+    else
+    {
+      std::cerr << "Usage: " << argv[0] << " [--games <n>] [--dir <saved_games>] [--skip-legacy]" << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<std::string> text, binary;
+  if (dir.empty())
+  {
+    for (const auto &game : buildGames(count))
+    {
+      text.push_back(TextSave::encode(game));
+      binary.push_back(BinarySave::encode(game));
+    }
+  }
+  else
+  {
+    for (const auto &entry : std::filesystem::directory_iterator(dir))
+    {
+      if (entry.path().extension() == ".gfl")
+        text.push_back(readFile(entry.path()));
+      else if (entry.path().extension() == BinarySave::extension)
+        binary.push_back(readFile(entry.path()));
+    }
+  }
+
+  // Same games from every parser before anything is timed, with spaces or tabs between move fields.
+  for (const auto &file : text)
+  {
+    Gaming fast = TextSave::decode(file);
+    if (legacy and legacyLoad(file).getSequence() != fast.getSequence())
+    {
+      std::cerr << "Parsers disagree on a game" << std::endl;
+      return 1;
+    }
+    try
+    {
+      if (TextSave::decode(tabSeparated(file)).getSequence() != fast.getSequence())
+      {
+        std::cerr << "Tab-separated moves decode to a different game" << std::endl;
+        return 1;
+      }
+    }
+    catch (SaveParseError &e)
+    {
+      std::cerr << "Tab-separated moves rejected: " << e.what() << std::endl;
+      return 1;
+    }
+  }
+
+  std::cout << text.size() << " text and " << binary.size() << " binary saves" << (dir.empty() ? " (generated)" : " from " + dir) << "\n"
+            << std::left << std::setw(20) << "parser" << std::right << std::setw(12) << "us/game" << std::setw(14) << "games/s"
+            << std::setw(14) << "moves/s" << std::setw(12) << "MB/s" << std::setw(12) << "KiB" << std::endl;
+  long long moves = 0;
+  double seconds;
+  if (not text.empty() and legacy)
+  {
+    seconds = timeLoads(text, legacyLoad, moves);
+    printRow("legacy regex", text, seconds, moves);
+  }
+  if (not text.empty())
+  {
+    seconds = timeLoads(text, [](const std::string &file)
+                        { return TextSave::decode(file); }, moves);
+    printRow("TextSave", text, seconds, moves);
+  }
+  if (not binary.empty())
+  {
+    seconds = timeLoads(binary, [](const std::string &file)
+                        { return BinarySave::decode(file); }, moves);
+    printRow("BinarySave", binary, seconds, moves);
+  }
+  return 0;
+}
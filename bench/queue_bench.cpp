@@ -0,0 +1,93 @@
+// Contention benchmark: SafeQueue vs MPSCQueue vs BoundedMPSCQueue.
+// N producer threads push items while one consumer drains them, like the backend command path.
+//
+// Build from the repository root:
+//   g++ -std=c++20 -O2 -pthread bench/queue_bench.cpp -o queue_bench
+// Usage:
+//   ./queue_bench [items_per_producer] [max_producers]
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/SafeQueue.h"
+#include "../src/MPSCQueue.h"
+
+namespace
+{
+  using Clock = std::chrono::steady_clock;
+
+  struct Payload
+  {
+    int producer;
+    int sequence;
+    std::string text; // Roughly the size of a log line or a small command
+  };
+
+  template <typename Queue, typename Push>
+  double run(Queue &queue, Push push, int producers, int items)
+  {
+    std::vector<std::thread> threads;
+    auto begin = Clock::now();
+    for (int p = 0; p < producers; p++)
+    {
+      threads.emplace_back([&queue, &push, p, items]()
+                           {
+                             for (int i = 0; i < items; i++)
+                             {
+                               push(queue, Payload{p, i, "1792361485 INFO | Preparing the board."});
+                             } });
+    }
+
+    long long total = static_cast<long long>(producers) * items, received = 0;
+    std::vector<int> last(producers, -1);
+    while (received < total)
+    {
+      Payload item = queue.pop();
+      if (item.sequence != last[item.producer] + 1)
+      {
+        std::cerr << "Order violated for producer " << item.producer << std::endl;
+        std::exit(1);
+      }
+      last[item.producer] = item.sequence;
+      received++;
+    }
+    auto end = Clock::now();
+    for (auto &t : threads)
+    {
+      t.join();
+    }
+    return std::chrono::duration<double, std::nano>(end - begin).count() / total;
+  }
+} // namespace
+
+int main(int argc, char **argv)
+{
+  int items = (argc > 1) ? std::atoi(argv[1]) : 200000;
+  int max_producers = (argc > 2) ? std::atoi(argv[2]) : static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+
+  std::cout << std::left << std::setw(12) << "producers" << std::setw(16) << "SafeQueue" << std::setw(16) << "MPSCQueue"
+            << std::setw(16) << "BoundedMPSC" << "(ns per item)" << std::endl;
+
+  for (int producers = 1; producers <= max_producers; producers *= 2)
+  {
+    GosFrontline::SafeQueue<Payload> locked;
+    GosFrontline::MPSCQueue<Payload> lockfree;
+    GosFrontline::BoundedMPSCQueue<Payload> ring(4096);
+
+    double a = run(locked, [](auto &q, Payload &&v)
+                   { q.push(std::move(v)); }, producers, items);
+    double b = run(lockfree, [](auto &q, Payload &&v)
+                   { q.push(std::move(v)); }, producers, items);
+    double c = run(ring, [](auto &q, Payload &&v)
+                   { q.push(std::move(v)); }, producers, items);
+
+    std::cout << std::left << std::fixed << std::setprecision(1) << std::setw(12) << producers
+              << std::setw(16) << a << std::setw(16) << b << std::setw(16) << c << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,301 @@
+// Self-play match runner: plays N games between two engine configurations and reports
+// win/draw/loss, the Elo difference with a 95% confidence interval, and nodes per second.
+// Every game is seeded from --seed and its index and starts from a fixed opening, with colours
+// swapped on each pair, so a run can be repeated exactly regardless of how many threads play it.
+// Gaming adjudicates: five (or an overline for Gote) wins, a forbidden move loses, a full board draws.
+//
+// Build from the repository root:
+//   g++ -std=c++20 -O2 -pthread bench/selfplay.cpp -o selfplay
+// Usage:
+//   ./selfplay [--a <engine>] [--b <engine>] [--games <n>] [--threads <n>] [--seed <s>] [--json <file|->]
+// Engines: random (MCTS::getRandomMove), greedy (one-ply: win, else block, else play next to a stone).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/MCTS.h"
+
+namespace
+{
+  using namespace GosFrontline;
+  using Clock = std::chrono::steady_clock;
+  using Square = std::pair<int, int>;
+
+  /// @brief Chooses a move for the side to move. Reports its work through @p info.
+  using Engine = std::function<Square(Gaming &game, unsigned seed, SearchInfo &info)>;
+
+  struct EngineConfig
+  {
+    std::string name;
+    Engine play;
+  };
+
+  Square playRandom(Gaming &game, unsigned seed, SearchInfo &info)
+  {
+    MCTS engine(seed);
+    engine.setInfoCallback([&info](const SearchInfo &report)
+                           { info = report; });
+    return engine.getRandomMove(game);
+  }
+
+  /// @brief One-ply baseline: complete a five, else block the opponent's, else a random legal
+  ///        square touching an existing stone.
+  Square playGreedy(Gaming &game, unsigned seed, SearchInfo &info)
+  {
+    auto begin = Clock::now();
+    PieceType me = game.toMove(), them = Opposite(me);
+    std::vector<Square> near;
+    Square block{-1, -1};
+    int rows = static_cast<int>(game.row_count()), cols = static_cast<int>(game.col_count());
+    info = SearchInfo();
+    info.depth = info.seldepth = 1;
+
+    for (int r = 0; r < rows; r++)
+    {
+      for (int c = 0; c < cols; c++)
+      {
+        if (not game.isEmpty(r, c))
+          continue;
+        info.nodes++;
+        bool legal = me == PieceType::Gote or not game.violation(r, c);
+        if (legal and (game.willFive(r, c, me) or (me == PieceType::Gote and game.willLong(r, c, me))))
+        {
+          info.pv = {{r, c}};
+          info.time = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - begin);
+          return {r, c};
+        }
+        if (legal and block.first < 0 and game.willFive(r, c, them))
+          block = {r, c};
+        bool touching = false;
+        for (int dr = -1; dr <= 1 and not touching; dr++)
+          for (int dc = -1; dc <= 1 and not touching; dc++)
+            touching = game.isValidCoord(r + dr, c + dc) and not game.isEmpty(r + dr, c + dc);
+        if (legal and touching)
+          near.emplace_back(r, c);
+      }
+    }
+
+    Square choice = block;
+    if (choice.first < 0 and not near.empty())
+    {
+      std::mt19937 gen(seed);
+      choice = near[std::uniform_int_distribution<size_t>(0, near.size() - 1)(gen)];
+    }
+    if (choice.first < 0)
+      choice = playRandom(game, seed, info);
+    info.pv = {choice};
+    info.time = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - begin);
+    return choice;
+  }
+
+  const std::vector<EngineConfig> engines = {{"random", playRandom}, {"greedy", playGreedy}};
+
+  // Fixed openings (Sente, Gote, Sente ...) around the centre of a 15x15 board.
+  const std::vector<std::vector<Square>> openings = {
+      {{7, 7}},
+      {{7, 7}, {7, 8}},
+      {{7, 7}, {6, 8}},
+      {{7, 7}, {7, 8}, {8, 8}},
+      {{7, 7}, {6, 8}, {6, 6}},
+      {{7, 7}, {8, 7}, {6, 9}},
+      {{7, 7}, {6, 7}, {8, 9}},
+      {{7, 7}, {8, 8}, {6, 8}},
+  };
+
+  enum class Outcome
+  {
+    AWins,
+    BWins,
+    Draw
+  };
+
+  struct EngineTally
+  {
+    unsigned long long nodes = 0;
+    long long micros = 0;
+  };
+
+  struct GameResult
+  {
+    Outcome outcome;
+    int moves;
+    EngineTally a, b;
+  };
+
+  /// @brief Game @p index: engine A plays Sente on even indices and Gote on odd ones.
+  GameResult playGame(const EngineConfig &a, const EngineConfig &b, int index, unsigned seed)
+  {
+    Gaming game(static_cast<int>(standardSize), static_cast<int>(standardSize), PieceType::None);
+    bool a_is_sente = index % 2 == 0;
+    GameResult result{Outcome::Draw, 0, {}, {}};
+    for (const auto &[r, c] : openings[(index / 2) % openings.size()])
+      game.makeMove(r, c);
+
+    const int cells = static_cast<int>(standardSize * standardSize);
+    unsigned move_seed = seed * 2654435761u + static_cast<unsigned>(index) * 40503u;
+    while (game.movesMade() < cells)
+    {
+      PieceType side = game.toMove();
+      bool a_to_move = (side == PieceType::Sente) == a_is_sente;
+      const EngineConfig &engine = a_to_move ? a : b;
+      EngineTally &tally = a_to_move ? result.a : result.b;
+
+      SearchInfo info;
+      auto begin = Clock::now();
+      Square move = engine.play(game, move_seed++, info);
+      tally.micros += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - begin).count();
+      tally.nodes += info.nodes;
+
+      Outcome loss = a_to_move ? Outcome::BWins : Outcome::AWins;
+      Outcome win = a_to_move ? Outcome::AWins : Outcome::BWins;
+      if (move.first < 0 or not game.isEmpty(move.first, move.second) or not game.makeMove(move.first, move.second))
+      {
+        result.outcome = loss; // No move, an occupied square or a forbidden move for Sente
+        break;
+      }
+      PieceType winner = game.checkCurrentWin(move.first, move.second);
+      if (winner != PieceType::None)
+      {
+        result.outcome = winner == side ? win : loss;
+        break;
+      }
+    }
+    result.moves = game.movesMade();
+    return result;
+  }
+
+  /// @brief Elo difference for a score fraction, clamped away from the infinities at 0 and 1.
+  double elo(double score)
+  {
+    score = std::clamp(score, 1e-4, 1 - 1e-4);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+  }
+
+  const EngineConfig *findEngine(const std::string &name)
+  {
+    for (const auto &engine : engines)
+      if (engine.name == name)
+        return &engine;
+    return nullptr;
+  }
+} // namespace
+
+int main(int argc, char **argv)
+{
+  std::string a_name = "greedy", b_name = "random", json_path;
+  int games = 200;
+  int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  unsigned seed = 1;
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--a") == 0 and i + 1 < argc)
+      a_name = argv[++i];
+    else if (std::strcmp(argv[i], "--b") == 0 and i + 1 < argc)
+      b_name = argv[++i];
+    else if (std::strcmp(argv[i], "--games") == 0 and i + 1 < argc)
+      games = std::max(1, std::atoi(argv[++i]));
+    else if (std::strcmp(argv[i], "--threads") == 0 and i + 1 < argc)
+      threads = std::max(1, std::atoi(argv[++i]));
+    else if (std::strcmp(argv[i], "--seed") == 0 and i + 1 < argc)
+      seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+    else if (std::strcmp(argv[i], "--json") == 0 and i + 1 < argc)
+      json_path = argv[++i];
+    else
+    {
+      std::cerr << "Usage: " << argv[0] << " [--a <engine>] [--b <engine>] [--games <n>] [--threads <n>] [--seed <s>] [--json <file|->]" << std::endl;
+      return 1;
+    }
+  }
+  const EngineConfig *a = findEngine(a_name), *b = findEngine(b_name);
+  if (a == nullptr or b == nullptr)
+  {
+    std::cerr << "Unknown engine. Available:";
+    for (const auto &engine : engines)
+      std::cerr << ' ' << engine.name;
+    std::cerr << std::endl;
+    return 1;
+  }
+
+  std::vector<GameResult> results(games);
+  std::atomic<int> next{0};
+  std::vector<std::thread> workers;
+  auto begin = Clock::now();
+  for (int t = 0; t < std::min(threads, games); t++)
+  {
+    workers.emplace_back([&]()
+                         {
+                           for (int i = next.fetch_add(1); i < games; i = next.fetch_add(1))
+                           {
+                             results[i] = playGame(*a, *b, i, seed);
+                           } });
+  }
+  for (auto &w : workers)
+    w.join();
+  double wall = std::chrono::duration<double>(Clock::now() - begin).count();
+
+  int wins = 0, losses = 0, draws = 0;
+  long long total_moves = 0;
+  EngineTally ta, tb;
+  for (const auto &r : results)
+  {
+    wins += r.outcome == Outcome::AWins;
+    losses += r.outcome == Outcome::BWins;
+    draws += r.outcome == Outcome::Draw;
+    total_moves += r.moves;
+    ta.nodes += r.a.nodes;
+    ta.micros += r.a.micros;
+    tb.nodes += r.b.nodes;
+    tb.micros += r.b.micros;
+  }
+
+  // Score per game is 1, 0.5 or 0; the interval comes from the standard error of the mean score.
+  double n = games;
+  double score = (wins + 0.5 * draws) / n;
+  double variance = (wins * std::pow(1 - score, 2) + draws * std::pow(0.5 - score, 2) + losses * std::pow(score, 2)) / n;
+  double margin = 1.96 * std::sqrt(variance / n);
+  double elo_mid = elo(score), elo_low = elo(score - margin), elo_high = elo(score + margin);
+  auto nps = [](const EngineTally &t)
+  { return t.micros > 0 ? t.nodes * 1e6 / t.micros : 0.0; };
+
+  std::cout << a->name << " vs " << b->name << ": " << games << " games, seed " << seed << ", " << threads << " threads, "
+            << std::fixed << std::setprecision(2) << wall << " s\n"
+            << "W/D/L " << wins << "/" << draws << "/" << losses << "  score " << std::setprecision(3) << score
+            << "  Elo " << std::showpos << std::setprecision(1) << elo_mid << " [" << elo_low << ", " << elo_high << "]"
+            << std::noshowpos << " (95%)\n"
+            << std::setprecision(0) << a->name << " " << nps(ta) << " nodes/s, " << b->name << " " << nps(tb) << " nodes/s, "
+            << std::setprecision(1) << static_cast<double>(total_moves) / games << " moves/game" << std::endl;
+
+  if (not json_path.empty())
+  {
+    std::ofstream file;
+    if (json_path != "-")
+    {
+      file.open(json_path);
+      if (not file.is_open())
+      {
+        std::cerr << "Could not write " << json_path << std::endl;
+        return 1;
+      }
+    }
+    std::ostream &out = json_path == "-" ? std::cout : file;
+    out << std::fixed << std::setprecision(3)
+        << "{\"a\": \"" << a->name << "\", \"b\": \"" << b->name << "\", \"games\": " << games << ", \"seed\": " << seed
+        << ", \"wins\": " << wins << ", \"draws\": " << draws << ", \"losses\": " << losses
+        << ", \"score\": " << score << ", \"elo\": " << elo_mid << ", \"elo_low\": " << elo_low << ", \"elo_high\": " << elo_high
+        << ", \"a_nps\": " << nps(ta) << ", \"b_nps\": " << nps(tb) << ", \"wall_seconds\": " << wall << "}" << std::endl;
+  }
+  return 0;
+}
@@ -14,12 +14,12 @@ int main()
     std::promise<bool> frontEnd, backEnd;
     std::future<bool> frontEndFuture = frontEnd.get_future(), backEndFuture = backEnd.get_future();
 
-    bool frontFinish = false, backFinish = false;
-
     GosFrontline::Backend &backend = GosFrontline::Backend::getBackend();
     GosFrontline::InterfaceCLI interface;
-    std::shared_ptr<GosFrontline::Logger> log = std::make_shared<GosFrontline::Logger>("Frontend");
-    std::shared_ptr<GosFrontline::Logger> log2 = std::make_shared<GosFrontline::Logger>("Backend");
+    // One log file for the whole program; each component writes on its own channel.
+    auto logService = std::make_shared<GosFrontline::LogService>("GosFrontline");
+    std::shared_ptr<GosFrontline::Logger> log = logService->channel("Frontend");
+    std::shared_ptr<GosFrontline::Logger> log2 = logService->channel("Backend");
 
     interface.setLogger(log);
     backend.setLogger(log2);
@@ -29,22 +29,12 @@ int main()
     auto backendThread = std::thread([&backend](std::promise<bool> end)
                                      {backend.run(); end.set_value(true); }, std::move(backEnd));
 
-    while (not(frontFinish and backFinish))
-    {
-        if ((not frontFinish) and frontEndFuture.wait_for(std::chrono::milliseconds(1)) == std::future_status::ready)
-        {
-            frontFinish = true;
-            log->log("Got Frontend Finish Signal.");
-        }
-
-        if ((not backFinish) and backEndFuture.wait_for(std::chrono::milliseconds(1)) == std::future_status::ready)
-        {
-            backFinish = true;
-            log2->log("Got Backend Finish Signal.");
-        }
-        log->run();
-        log2->run();
-    }
+    // The loggers write from their own threads, so the main thread only waits for both ends to finish.
+    frontEndFuture.wait();
+    log->log("Got Frontend Finish Signal.");
+
+    backEndFuture.wait();
+    log2->log("Got Backend Finish Signal.");
 
     frontendThread.join();
     backendThread.join();
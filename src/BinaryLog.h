@@ -0,0 +1,475 @@
+#ifndef BINARYLOG_H
+#define BINARYLOG_H
+
+/// Binary log sink: fixed-size records in a memory-mapped ring file, for tracing that is too
+/// hot for text logging. Format strings are stored once in the file's dictionary and records
+/// only carry their id, raw timestamp ticks and arguments; string arguments go to a separate
+/// byte ring and the record keeps where. BinaryLogReader (used by
+/// tools/glog_decode.cpp) turns a file back into the usual text log lines.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GOSFRONTLINE_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace GosFrontline
+{
+  struct BinaryLogHeader
+  {
+    char magic[8];                   // "GFLBLOG1"
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t capacity;               // Records in the ring
+    uint64_t dictionary_offset, dictionary_size;
+    uint64_t records_offset;
+    int64_t tick_num, tick_den;      // system_clock period of the stored ticks
+    std::atomic<uint64_t> next;      // Next record index to hand out
+    std::atomic<uint64_t> dictionary_used;
+    uint64_t strings_offset, strings_size;
+    std::atomic<uint64_t> strings_used; // Bytes ever handed out; the ring holds the last strings_size of them
+  };
+
+  /// @brief One log call. 64 bytes, so a record never straddles two cache lines.
+  struct BinaryLogRecord
+  {
+    std::atomic<uint64_t> sequence; // Record index + 1 once complete, 0 while being written
+    int64_t ticks;
+    uint16_t message_id;
+    uint8_t type;
+    uint8_t argc;
+    uint8_t kinds;                  // 2 bits per argument, see ArgKind
+    uint8_t reserved;
+    uint16_t channel;               // Dictionary id of the channel name + 1; 0 for the unnamed channel
+    uint16_t thread;                // Dictionary id of the thread id as text + 1; 0 if not recorded
+    int16_t row, col;               // -1 when not set
+    uint16_t padding;
+    int64_t latency_us;
+    int64_t args[3];
+  };
+  static_assert(sizeof(BinaryLogRecord) == 64, "BinaryLogRecord must stay 64 bytes");
+
+  enum class ArgKind : uint8_t
+  {
+    Integer = 0,
+    Real,
+    Boolean,
+    String // (start << 16) | length in the string ring, or -1 for a type that is not stored
+  };
+
+  class BinaryLogSink
+  {
+  public:
+    static constexpr char magic[8] = {'G', 'F', 'L', 'B', 'L', 'O', 'G', '1'};
+    static constexpr uint32_t version = 3;
+    static constexpr size_t header_size = 256;
+    static constexpr size_t max_args = 3;
+    static_assert(sizeof(BinaryLogHeader) <= header_size, "BinaryLogHeader must fit in header_size");
+
+    /// @brief Create (or truncate) @p path holding @p capacity records, a @p dictionary_bytes format table
+    ///        and a @p string_bytes ring for string arguments.
+    /// @throws std::runtime_error if the file cannot be created or mapped.
+    BinaryLogSink(const std::string &path, size_t capacity = 1 << 16, size_t dictionary_bytes = 1 << 16, size_t string_bytes = 1 << 16)
+        : serial(nextSerial())
+    {
+#ifdef GOSFRONTLINE_HAS_MMAP
+      size_t strings_offset = header_size + dictionary_bytes;
+      size_t records_offset = strings_offset + string_bytes;
+      records_offset = (records_offset + 63) / 64 * 64;
+      mapped_size = records_offset + capacity * sizeof(BinaryLogRecord);
+
+      int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+      if (fd < 0)
+        throw std::runtime_error("Could not create binary log " + path);
+      if (::ftruncate(fd, static_cast<off_t>(mapped_size)) != 0)
+      {
+        ::close(fd);
+        throw std::runtime_error("Could not size binary log " + path);
+      }
+      void *memory = ::mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      ::close(fd);
+      if (memory == MAP_FAILED)
+        throw std::runtime_error("Could not map binary log " + path);
+      base = static_cast<char *>(memory);
+
+      header = new (base) BinaryLogHeader;
+      std::memcpy(header->magic, magic, sizeof(magic));
+      header->version = version;
+      header->record_size = sizeof(BinaryLogRecord);
+      header->capacity = capacity;
+      header->dictionary_offset = header_size;
+      header->dictionary_size = dictionary_bytes;
+      header->records_offset = records_offset;
+      header->tick_num = std::chrono::system_clock::period::num;
+      header->tick_den = std::chrono::system_clock::period::den;
+      header->next.store(0);
+      header->dictionary_used.store(0);
+      header->strings_offset = strings_offset;
+      header->strings_size = string_bytes;
+      header->strings_used.store(0);
+
+      records = reinterpret_cast<BinaryLogRecord *>(base + records_offset);
+      for (size_t i = 0; i < capacity; i++)
+      {
+        new (&records[i].sequence) std::atomic<uint64_t>(0);
+      }
+#else
+      (void)path;
+      (void)capacity;
+      (void)dictionary_bytes;
+      (void)string_bytes;
+      throw std::runtime_error("Binary logging needs mmap, which this platform does not provide.");
+#endif
+    }
+
+    BinaryLogSink(const BinaryLogSink &) = delete;
+    BinaryLogSink &operator=(const BinaryLogSink &) = delete;
+
+    ~BinaryLogSink()
+    {
+#ifdef GOSFRONTLINE_HAS_MMAP
+      if (base != nullptr)
+        ::munmap(base, mapped_size);
+#endif
+    }
+
+    /// @brief Append one record. Safe from any thread; the oldest record is overwritten when the ring is full.
+    template <typename... Args>
+    void write(int type, std::string_view channel, int row, int col, long long latency_us, std::thread::id thread,
+               std::string_view format, const Args &...args)
+    {
+      BinaryLogRecord record_args{};
+      record_args.argc = static_cast<uint8_t>(std::min(sizeof...(Args), max_args));
+      [[maybe_unused]] size_t slot = 0; // Unused when there are no arguments
+      (storeArg(record_args, slot, args), ...);
+
+      uint16_t id = intern(format);
+      uint16_t channel_id = channel.empty() ? 0 : static_cast<uint16_t>(intern(channel) + 1);
+      uint16_t thread_id = thread == std::thread::id() ? 0 : static_cast<uint16_t>(internThread(thread) + 1);
+      uint64_t index = header->next.fetch_add(1, std::memory_order_relaxed);
+      BinaryLogRecord &record = records[index % header->capacity];
+      record.sequence.store(0, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      record.ticks = std::chrono::system_clock::now().time_since_epoch().count();
+      record.message_id = id;
+      record.type = static_cast<uint8_t>(type);
+      record.argc = record_args.argc;
+      record.kinds = record_args.kinds;
+      record.channel = channel_id;
+      record.thread = thread_id;
+      record.row = static_cast<int16_t>(row);
+      record.col = static_cast<int16_t>(col);
+      record.latency_us = latency_us;
+      std::memcpy(record.args, record_args.args, sizeof(record.args));
+      record.sequence.store(index + 1, std::memory_order_release);
+    }
+
+  private:
+    char *base = nullptr;
+    size_t mapped_size = 0;
+    BinaryLogHeader *header = nullptr;
+    BinaryLogRecord *records = nullptr;
+    uint64_t serial; // Distinguishes sinks in the per-thread id caches
+    std::mutex dictionary_mutex;
+    std::unordered_map<std::string, uint16_t> dictionary; // Format text -> id, guarded by dictionary_mutex
+
+    struct CachedFormat
+    {
+      uint16_t id;
+      std::string text; // Compared on every hit, so two formats with the same hash never share an id
+    };
+
+    static uint64_t nextSerial()
+    {
+      static std::atomic<uint64_t> counter{0};
+      return ++counter;
+    }
+
+    template <typename T>
+    void storeArg(BinaryLogRecord &record, size_t &slot, const T &value)
+    {
+      if (slot >= max_args)
+        return;
+      ArgKind kind = ArgKind::String;
+      int64_t bits = -1;
+      if constexpr (std::is_same_v<T, bool>)
+      {
+        kind = ArgKind::Boolean;
+        bits = value;
+      }
+      else if constexpr (std::is_integral_v<T>)
+      {
+        kind = ArgKind::Integer;
+        bits = static_cast<int64_t>(value);
+      }
+      else if constexpr (std::is_enum_v<T>)
+      {
+        kind = ArgKind::Integer;
+        bits = static_cast<int64_t>(value);
+      }
+      else if constexpr (std::is_floating_point_v<T>)
+      {
+        kind = ArgKind::Real;
+        double real = static_cast<double>(value);
+        std::memcpy(&bits, &real, sizeof(bits));
+      }
+      else if constexpr (std::is_convertible_v<const T &, std::string_view>)
+      {
+        bits = storeString(value);
+      }
+      record.args[slot] = bits;
+      record.kinds |= static_cast<uint8_t>(static_cast<uint8_t>(kind) << (2 * slot));
+      slot++;
+    }
+
+    /// @brief Copy @p text into the string ring, wrapping at its end.
+    /// @return (start << 16) | length, start counting every byte ever stored; -1 if there is no ring.
+    int64_t storeString(std::string_view text)
+    {
+      uint64_t size = header->strings_size;
+      if (size == 0)
+        return -1;
+      size_t length = std::min<size_t>({text.size(), UINT16_MAX, size});
+      uint64_t start = header->strings_used.fetch_add(length, std::memory_order_relaxed);
+      char *ring = base + header->strings_offset;
+      size_t at = static_cast<size_t>(start % size);
+      size_t first = std::min<size_t>(length, size - at);
+      std::memcpy(ring + at, text.data(), first);
+      std::memcpy(ring, text.data() + first, length - first);
+      return static_cast<int64_t>((start << 16) | length);
+    }
+
+    /// @brief Id of @p format in this file's dictionary, adding it on first use.
+    ///        Each thread caches ids, so the lock is only taken for formats it has not seen.
+    uint16_t intern(std::string_view format)
+    {
+      uint64_t hash = std::hash<std::string_view>()(format);
+      thread_local std::unordered_map<uint64_t, std::unordered_map<uint64_t, CachedFormat>> cache;
+      auto &mine = cache[serial];
+      auto hit = mine.find(hash);
+      if (hit != mine.end() and hit->second.text == format)
+        return hit->second.id;
+
+      std::lock_guard<std::mutex> lock(dictionary_mutex);
+      std::string text(format);
+      auto found = dictionary.find(text);
+      uint16_t id;
+      if (found != dictionary.end())
+      {
+        id = found->second;
+      }
+      else
+      {
+        id = static_cast<uint16_t>(dictionary.size());
+        size_t length = std::min<size_t>(format.size(), UINT16_MAX);
+        uint64_t used = header->dictionary_used.load(std::memory_order_relaxed);
+        if (used + 4 + length <= header->dictionary_size)
+        {
+          char *entry = base + header->dictionary_offset + used;
+          uint16_t fields[2] = {id, static_cast<uint16_t>(length)};
+          std::memcpy(entry, fields, sizeof(fields));
+          std::memcpy(entry + 4, format.data(), length);
+          header->dictionary_used.store(used + 4 + length, std::memory_order_release);
+        }
+        dictionary.emplace(text, id);
+      }
+      mine[hash] = CachedFormat{id, std::move(text)};
+      return id;
+    }
+
+    /// @brief Dictionary id of @p thread printed the way the text sink prints it; cached per thread.
+    uint16_t internThread(std::thread::id thread)
+    {
+      thread_local std::unordered_map<uint64_t, std::unordered_map<std::thread::id, uint16_t>> cache;
+      auto &mine = cache[serial];
+      auto hit = mine.find(thread);
+      if (hit != mine.end())
+        return hit->second;
+      std::ostringstream text;
+      text << thread;
+      uint16_t id = intern(text.str());
+      mine.emplace(thread, id);
+      return id;
+    }
+  };
+
+  /// @brief Reads a binary log file back, oldest surviving record first.
+  class BinaryLogReader
+  {
+  public:
+    /// @throws std::runtime_error if @p path is not a binary log.
+    explicit BinaryLogReader(const std::string &path)
+    {
+      std::ifstream in(path, std::ios::binary);
+      if (not in.is_open())
+        throw std::runtime_error("Could not open " + path);
+      data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+      if (data.size() < BinaryLogSink::header_size or std::memcmp(data.data(), BinaryLogSink::magic, sizeof(BinaryLogSink::magic)) != 0)
+        throw std::runtime_error(path + " is not a GosFrontline binary log.");
+
+      std::memcpy(&version, data.data() + offsetof(BinaryLogHeader, version), sizeof(version));
+      std::memcpy(&capacity, data.data() + offsetof(BinaryLogHeader, capacity), sizeof(capacity));
+      std::memcpy(&records_offset, data.data() + offsetof(BinaryLogHeader, records_offset), sizeof(records_offset));
+      std::memcpy(&tick_num, data.data() + offsetof(BinaryLogHeader, tick_num), sizeof(tick_num));
+      std::memcpy(&tick_den, data.data() + offsetof(BinaryLogHeader, tick_den), sizeof(tick_den));
+      std::memcpy(&strings_offset, data.data() + offsetof(BinaryLogHeader, strings_offset), sizeof(strings_offset));
+      std::memcpy(&strings_size, data.data() + offsetof(BinaryLogHeader, strings_size), sizeof(strings_size));
+      std::memcpy(&strings_used, data.data() + offsetof(BinaryLogHeader, strings_used), sizeof(strings_used));
+      uint64_t dictionary_offset, dictionary_used;
+      std::memcpy(&dictionary_offset, data.data() + offsetof(BinaryLogHeader, dictionary_offset), sizeof(dictionary_offset));
+      std::memcpy(&dictionary_used, data.data() + offsetof(BinaryLogHeader, dictionary_used), sizeof(dictionary_used));
+      if (version != BinaryLogSink::version or records_offset + capacity * sizeof(BinaryLogRecord) > data.size() or
+          strings_offset + strings_size > data.size())
+        throw std::runtime_error(path + " has an unsupported version or is truncated.");
+
+      for (uint64_t at = 0; at + 4 <= dictionary_used;)
+      {
+        uint16_t fields[2];
+        std::memcpy(fields, data.data() + dictionary_offset + at, sizeof(fields));
+        if (formats.size() <= fields[0])
+          formats.resize(fields[0] + 1);
+        formats[fields[0]].assign(data.data() + dictionary_offset + at + 4, fields[1]);
+        at += 4 + fields[1];
+      }
+    }
+
+    /// @brief Write every complete record as a text log line: "<ms> <TYPE> [Channel] | <message> {fields}".
+    void render(std::ostream &out) const
+    {
+      static const char *names[] = {"INFO", "WARNING", "ERROR", "DEBUG", "FATAL"};
+      std::vector<const char *> complete;
+      for (uint64_t i = 0; i < capacity; i++)
+      {
+        const char *raw = data.data() + records_offset + i * sizeof(BinaryLogRecord);
+        uint64_t sequence;
+        std::memcpy(&sequence, raw, sizeof(sequence));
+        if (sequence != 0)
+          complete.push_back(raw);
+      }
+      std::sort(complete.begin(), complete.end(), [](const char *a, const char *b)
+                {
+                  uint64_t sa, sb;
+                  std::memcpy(&sa, a, sizeof(sa));
+                  std::memcpy(&sb, b, sizeof(sb));
+                  return sa < sb; });
+
+      for (const char *raw : complete)
+      {
+        BinaryLogRecord record;
+        std::memcpy(static_cast<void *>(&record), raw, sizeof(record));
+        long long ms = static_cast<long long>(static_cast<long double>(record.ticks) * tick_num / tick_den * 1000);
+        out << ms << ' ' << (record.type < 5 ? names[record.type] : "UNKNOWN");
+        if (record.channel != 0 and record.channel <= formats.size())
+          out << " [" << formats[record.channel - 1] << ']';
+        out << " | ";
+        renderMessage(out, record);
+        bool has_thread = record.thread != 0 and record.thread <= formats.size();
+        if (record.row >= 0 or record.latency_us >= 0 or has_thread)
+        {
+          std::ostringstream fields; // Same order as the text sink
+          if (record.row >= 0)
+            fields << " move=(" << record.row << ", " << record.col << ")";
+          if (has_thread)
+            fields << " thread=" << formats[record.thread - 1];
+          if (record.latency_us >= 0)
+            fields << " latency_us=" << record.latency_us;
+          out << " {" << fields.str().substr(1) << "}";
+        }
+        out << '\n';
+      }
+    }
+
+  private:
+    std::vector<char> data;
+    std::vector<std::string> formats;
+    uint32_t version = 0;
+    uint64_t capacity = 0, records_offset = 0;
+    uint64_t strings_offset = 0, strings_size = 0, strings_used = 0;
+    int64_t tick_num = 1, tick_den = 1;
+
+    void renderMessage(std::ostream &out, const BinaryLogRecord &record) const
+    {
+      if (record.message_id >= formats.size())
+      {
+        out << "<message " << record.message_id << " missing from dictionary>";
+        return;
+      }
+      std::string_view format = formats[record.message_id];
+      size_t arg = 0;
+      while (true)
+      {
+        size_t hole = format.find("{}");
+        if (hole == std::string_view::npos)
+          break;
+        out << format.substr(0, hole);
+        if (arg < record.argc)
+        {
+          auto kind = static_cast<ArgKind>((record.kinds >> (2 * arg)) & 3u);
+          switch (kind)
+          {
+          case ArgKind::Integer:
+            out << record.args[arg];
+            break;
+          case ArgKind::Real:
+          {
+            double real;
+            std::memcpy(&real, &record.args[arg], sizeof(real));
+            out << real;
+            break;
+          }
+          case ArgKind::Boolean:
+            out << (record.args[arg] ? "true" : "false");
+            break;
+          case ArgKind::String:
+          default:
+            renderString(out, record.args[arg]);
+            break;
+          }
+        }
+        else
+        {
+          out << '?';
+        }
+        arg++;
+        format = format.substr(hole + 2);
+      }
+      out << format;
+    }
+
+    /// @brief Print a string argument, or "?" if it was not stored or later strings have overwritten it.
+    void renderString(std::ostream &out, int64_t bits) const
+    {
+      uint64_t start = static_cast<uint64_t>(bits) >> 16;
+      uint64_t length = static_cast<uint64_t>(bits) & 0xFFFF;
+      if (bits < 0 or strings_size == 0 or start + length > strings_used or start + strings_size < strings_used)
+      {
+        out << '?';
+        return;
+      }
+      for (uint64_t i = 0; i < length; i++)
+        out << data[strings_offset + (start + i) % strings_size];
+    }
+  };
+
+} // namespace GosFrontline
+
+#endif // BINARYLOG_H
@@ -4,6 +4,7 @@
 /// @author Shane-Xue
 
 #include <cassert>
+#include <iostream>
 #include <string>
 #include <stdexcept>
 #include <type_traits>
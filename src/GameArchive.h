@@ -0,0 +1,472 @@
+#ifndef GAMEARCHIVE_H
+#define GAMEARCHIVE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "SaveFormat.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GOSFRONTLINE_HAS_FSYNC 1
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace GosFrontline
+{
+  /// @brief How an archived game ended, judged from its last move when it was added.
+  enum class ArchiveResult : uint8_t
+  {
+    Unfinished = 0,
+    SenteWin,
+    GoteWin,
+    Draw // Board full
+  };
+
+  /// @brief One game's line in the archive index. Enough to list and filter games without reading them.
+  struct ArchiveEntry
+  {
+    uint64_t offset = 0; // Start of the game's BinarySave record in the archive
+    uint32_t length = 0; // Record size in bytes
+    uint64_t hash = 0;   // GameArchive::hash: equal board sizes and move lists give equal hashes
+    uint32_t moves = 0;
+    ArchiveResult result = ArchiveResult::Unfinished;
+    std::string sente, gote;
+  };
+
+  /// @brief Many games in one file with a random-access index at the end. Little-endian layout:
+  ///        "GFLA" | version u8 | 3 reserved bytes |
+  ///        then per append: the new BinarySave records, back to back |
+  ///        an index segment: end of the previous segment's footer (varint, 0 for none), entry count (varint),
+  ///               then per entry offset, length (varints), hash (u64), moves (varint), result u8,
+  ///               sente and gote names (varint length + bytes) |
+  ///        footer: segment offset u64 | CRC-32 of the segment u32 | "GFLI".
+  ///        The index is the chain of segments ending at the last footer, oldest first. Opening reads only
+  ///        that chain; load() then seeks straight to one record.
+  /// @note Not thread-safe: load() moves the shared file position. Open one GameArchive per thread.
+  class GameArchive
+  {
+  public:
+    static constexpr char magic[4] = {'G', 'F', 'L', 'A'};
+    static constexpr char footer_magic[4] = {'G', 'F', 'L', 'I'};
+    static constexpr uint8_t version = 2;
+    static constexpr size_t header_size = 8;
+    static constexpr size_t footer_size = 16;
+    static constexpr const char *extension = ".gfla";
+
+    /// @throws std::runtime_error if @p path cannot be read or is not a complete archive.
+    explicit GameArchive(const std::filesystem::path &path)
+        : file(path, std::ios::in | std::ios::binary)
+    {
+      if (not file.is_open())
+        throw std::runtime_error("Could not open archive " + path.string() + ".");
+      uint64_t end = 0;
+      index = locate(std::filesystem::file_size(path), StreamReader{file}, end);
+    }
+
+    size_t size() const { return index.size(); }
+    const std::vector<ArchiveEntry> &entries() const { return index; }
+    const ArchiveEntry &entry(size_t i) const { return index.at(i); }
+
+    /// @brief The raw BinarySave record of game @p i.
+    std::string record(size_t i)
+    {
+      const ArchiveEntry &e = index.at(i);
+      std::string data(e.length, '\0');
+      file.seekg(static_cast<std::streamoff>(e.offset));
+      if (not file.read(data.data(), static_cast<std::streamsize>(data.size())))
+        throw std::runtime_error("Archive is truncated at game " + std::to_string(i + 1) + ".");
+      return data;
+    }
+
+    /// @brief Read and decode game @p i only.
+    Gaming load(size_t i)
+    {
+      return BinarySave::decode(record(i));
+    }
+
+    /// @brief Whether @p data starts like an archive.
+    static bool detect(std::string_view data)
+    {
+      return data.size() >= sizeof(magic) and std::memcmp(data.data(), magic, sizeof(magic)) == 0;
+    }
+
+    /// @brief FNV-1a over the board size and the move list, ignoring names and save time,
+    ///        so the same game saved twice hashes the same.
+    static uint64_t hash(const Gaming &game)
+    {
+      uint64_t h = 14695981039346656037ull;
+      auto mix = [&h](uint64_t value)
+      {
+        for (int i = 0; i < 8; i++)
+        {
+          h ^= (value >> (8 * i)) & 0xFF;
+          h *= 1099511628211ull;
+        }
+      };
+      mix(game.row_count());
+      mix(game.col_count());
+      for (const auto &move : game.getSequence())
+        mix(static_cast<uint64_t>(std::get<0>(move)) * game.col_count() + std::get<1>(move));
+      return h;
+    }
+
+    static ArchiveResult result(const Gaming &game)
+    {
+      const auto &moves = game.getSequence();
+      if (moves.empty())
+        return ArchiveResult::Unfinished;
+      PieceType winner = game.checkCurrentWin(std::get<0>(moves.back()), std::get<1>(moves.back()));
+      if (winner == PieceType::Sente)
+        return ArchiveResult::SenteWin;
+      if (winner == PieceType::Gote)
+        return ArchiveResult::GoteWin;
+      return moves.size() == game.row_count() * game.col_count() ? ArchiveResult::Draw : ArchiveResult::Unfinished;
+    }
+
+  private:
+    /// @brief One index segment on disk, from its first byte to the end of its footer.
+    struct Segment
+    {
+      uint64_t begin = 0, end = 0;
+      size_t count = 0;
+    };
+
+    /// @brief Reads @p length bytes at @p offset of a stream, for locate().
+    struct StreamReader
+    {
+      std::istream &in;
+
+      std::string operator()(uint64_t offset, size_t length) const
+      {
+        std::string data(length, '\0');
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(offset));
+        if (not in.read(data.data(), static_cast<std::streamsize>(length)))
+          throw std::runtime_error("Game archive is truncated.");
+        return data;
+      }
+    };
+
+  public:
+    /// @brief Appends games to an archive, creating it if needed. New records and an index segment for
+    ///        them go after the last footer, so the file only ever grows and nothing already written is
+    ///        touched: until close() has synced the new footer, readers still find the previous one.
+    ///        An append cut short by a crash is dropped the next time a Writer opens the archive.
+    class Writer
+    {
+    public:
+      /// @throws std::runtime_error if @p path exists but is not an archive, or cannot be written.
+      explicit Writer(const std::filesystem::path &path)
+          : path(path)
+      {
+        std::error_code ec;
+        if (std::filesystem::exists(path, ec) and std::filesystem::file_size(path, ec) > 0)
+        {
+          uint64_t size = std::filesystem::file_size(path);
+          {
+            std::ifstream in(path, std::ios::in | std::ios::binary);
+            index = locate(size, StreamReader{in}, end, &segments);
+          }
+          if (end < size)
+            std::filesystem::resize_file(path, end); // Torn tail of an interrupted append
+          committed = index.size();
+          file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+        }
+        else
+        {
+          file.open(path, std::ios::out | std::ios::trunc | std::ios::binary);
+          std::string header(magic, sizeof(magic));
+          header += static_cast<char>(version);
+          header.append(3, '\0');
+          file.write(header.data(), static_cast<std::streamsize>(header.size()));
+          end = header_size;
+        }
+        if (not file.is_open() or not file)
+          throw std::runtime_error("Could not write archive " + path.string() + ".");
+      }
+
+      Writer(const Writer &) = delete;
+      Writer &operator=(const Writer &) = delete;
+
+      ~Writer()
+      {
+        try
+        {
+          close();
+        }
+        catch (std::exception &)
+        {
+        }
+      }
+
+      /// @brief Append @p game.
+      /// @return The game's position in the archive.
+      /// @throws std::invalid_argument if the game cannot be stored as a BinarySave.
+      size_t add(const Gaming &game)
+      {
+        ArchiveEntry e;
+        e.hash = GameArchive::hash(game);
+        e.moves = static_cast<uint32_t>(game.movesMade());
+        e.result = GameArchive::result(game);
+        e.sente = game.getSenteName();
+        e.gote = game.getGoteName();
+        return add(BinarySave::encode(game), std::move(e));
+      }
+
+      /// @brief Append a BinarySave @p record as is, listed with @p e (its offset and length are filled in).
+      ///        Used to copy games between archives without decoding them.
+      size_t add(std::string_view record, ArchiveEntry e)
+      {
+        e.offset = end;
+        e.length = static_cast<uint32_t>(record.size());
+        file.seekp(static_cast<std::streamoff>(end));
+        file.write(record.data(), static_cast<std::streamsize>(record.size()));
+        end += record.size();
+        index.push_back(std::move(e));
+        dirty = true;
+        return index.size() - 1;
+      }
+
+      size_t size() const { return index.size(); }
+      const std::vector<ArchiveEntry> &entries() const { return index; }
+
+      /// @brief File size once the pending appends are closed.
+      uint64_t bytes() const { return end; }
+
+      /// @brief Bytes no index reaches any more: segments, and their footers, merged into later ones.
+      uint64_t garbage() const
+      {
+        uint64_t live = header_size;
+        for (const auto &e : index)
+          live += e.length;
+        for (const auto &segment : segments)
+          live += segment.end - segment.begin;
+        return end - std::min(end, live);
+      }
+
+      /// @brief Sync the new records, then write an index segment and footer for them and sync again.
+      ///        Further add() calls are allowed and need another close().
+      /// @throws std::runtime_error if the file cannot be written or synced; the previous index stays in force.
+      void close()
+      {
+        if (not dirty or not file.is_open())
+          return;
+        sync(); // Records are on disk before any footer points at them
+
+        // The new entries form one segment, which absorbs the segments before it while they are no
+        // larger. Like a binary counter this keeps at most log2(n) + 1 segments for n games, and each
+        // entry is rewritten O(log n) times over the archive's life.
+        size_t count = index.size() - committed;
+        while (not segments.empty() and segments.back().count <= count)
+        {
+          count += segments.back().count;
+          segments.pop_back();
+        }
+        std::string out;
+        BinarySave::putVarint(out, segments.empty() ? 0 : segments.back().end);
+        BinarySave::putVarint(out, count);
+        for (size_t i = index.size() - count; i < index.size(); i++)
+        {
+          const ArchiveEntry &e = index[i];
+          BinarySave::putVarint(out, e.offset);
+          BinarySave::putVarint(out, e.length);
+          putFixed(out, e.hash, 8);
+          BinarySave::putVarint(out, e.moves);
+          out += static_cast<char>(e.result);
+          BinarySave::putString(out, e.sente);
+          BinarySave::putString(out, e.gote);
+        }
+        uint32_t crc = BinarySave::crc32(out.data(), out.size());
+        putFixed(out, end, 8);
+        putFixed(out, crc, 4);
+        out.append(footer_magic, sizeof(footer_magic));
+        file.seekp(static_cast<std::streamoff>(end));
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        sync();
+        segments.push_back(Segment{end, end + out.size(), count});
+        end += out.size();
+        committed = index.size();
+        dirty = false;
+      }
+
+    private:
+      std::filesystem::path path;
+      std::fstream file;
+      std::vector<ArchiveEntry> index;
+      std::vector<Segment> segments; // The index chain on disk, oldest first
+      size_t committed = 0;          // Entries listed by a segment on disk
+      uint64_t end = 0;              // Where the next record (or segment) goes
+      bool dirty = false;
+
+      void sync()
+      {
+        file.flush();
+        if (not file)
+          throw std::runtime_error("Could not write archive " + path.string() + ".");
+#ifdef GOSFRONTLINE_HAS_FSYNC
+        int fd = ::open(path.c_str(), O_WRONLY);
+        bool synced = fd >= 0 and ::fsync(fd) == 0;
+        if (fd >= 0)
+          ::close(fd);
+        if (not synced)
+          throw std::runtime_error("Could not sync archive " + path.string() + ".");
+#endif
+      }
+    };
+
+  private:
+    std::ifstream file;
+    std::vector<ArchiveEntry> index;
+
+    static void putFixed(std::string &out, uint64_t value, int bytes)
+    {
+      for (int i = 0; i < bytes; i++)
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+
+    static uint64_t getFixed(const char *data, int bytes)
+    {
+      uint64_t value = 0;
+      for (int i = 0; i < bytes; i++)
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+      return value;
+    }
+
+    /// @brief Follow the segment chain back from the footer that ends at @p end.
+    template <typename Read>
+    static std::vector<ArchiveEntry> readChain(std::string_view header, uint64_t end, const Read &read, std::vector<Segment> *segments)
+    {
+      std::vector<std::vector<ArchiveEntry>> parts;
+      std::vector<Segment> chain;
+      for (uint64_t at = end; at != 0;)
+      {
+        if (at < header_size + footer_size)
+          throw std::runtime_error("Game archive index chain is broken.");
+        std::string footer = read(at - footer_size, footer_size);
+        uint32_t crc = 0;
+        uint64_t offset = parseFooter(header, footer, at, crc);
+        uint64_t previous = 0;
+        parts.push_back(parseIndex(read(offset, at - footer_size - offset), crc, offset, previous));
+        if (previous > offset)
+          throw std::runtime_error("Game archive index chain is broken.");
+        chain.push_back(Segment{offset, at, parts.back().size()});
+        at = previous;
+      }
+      std::vector<ArchiveEntry> entries;
+      for (auto part = parts.rbegin(); part != parts.rend(); ++part)
+        std::move(part->begin(), part->end(), std::back_inserter(entries));
+      if (segments)
+        segments->assign(chain.rbegin(), chain.rend());
+      return entries;
+    }
+
+    /// @brief Check the @p header and @p footer bytes of an archive that is @p file_size bytes long.
+    /// @param crc Set to the stored checksum of the index segment.
+    /// @return Where the index segment starts.
+    static uint64_t parseFooter(std::string_view header, std::string_view footer, uint64_t file_size, uint32_t &crc)
+    {
+      if (file_size < header_size + footer_size or header.size() < header_size or not detect(header))
+        throw std::runtime_error("Not a game archive.");
+      if (static_cast<uint8_t>(header[4]) != version)
+        throw std::runtime_error("Game archive version " + std::to_string(static_cast<uint8_t>(header[4])) + " is not supported.");
+      if (footer.size() < footer_size or std::memcmp(footer.data() + 12, footer_magic, sizeof(footer_magic)) != 0)
+        throw std::runtime_error("Game archive has no index; it may not have been closed.");
+      uint64_t index_offset = getFixed(footer.data(), 8);
+      crc = static_cast<uint32_t>(getFixed(footer.data() + 8, 4));
+      if (index_offset < header_size or index_offset > file_size - footer_size)
+        throw std::runtime_error("Game archive index is out of range.");
+      return index_offset;
+    }
+
+    /// @brief Decode the index segment @p data, which starts at @p index_offset and should match @p crc.
+    /// @param previous Set to the end of the previous segment's footer, 0 for the first segment.
+    static std::vector<ArchiveEntry> parseIndex(std::string_view data, uint32_t crc, uint64_t index_offset, uint64_t &previous)
+    {
+      if (BinarySave::crc32(data.data(), data.size()) != crc)
+        throw std::runtime_error("Game archive index is corrupt: checksum mismatch.");
+
+      BinarySave::Reader reader{data, 0};
+      previous = reader.varint();
+      uint64_t count = reader.varint();
+      std::vector<ArchiveEntry> entries;
+      entries.reserve(static_cast<size_t>(std::min<uint64_t>(count, data.size())));
+      for (uint64_t i = 0; i < count; i++)
+      {
+        ArchiveEntry e;
+        e.offset = reader.varint();
+        e.length = static_cast<uint32_t>(reader.varint());
+        e.hash = getFixed(reader.bytes(8).data(), 8);
+        e.moves = static_cast<uint32_t>(reader.varint());
+        e.result = static_cast<ArchiveResult>(reader.byte());
+        e.sente = reader.string();
+        e.gote = reader.string();
+        if (e.offset < header_size or e.offset + e.length > index_offset)
+          throw std::runtime_error("Game archive entry " + std::to_string(i + 1) + " points outside the file.");
+        entries.push_back(std::move(e));
+      }
+      return entries;
+    }
+
+  public:
+    /// @brief Find the index of an archive @p file_size bytes long, reading it through @p read(offset, length).
+    ///        Starts at the footer that ends the file. If that one is torn or fails its checksum (an append
+    ///        cut short by a crash), falls back to the last footer before it whose whole chain checks out.
+    /// @param end Set to the end of the footer used; anything after it is an unfinished append.
+    /// @throws std::runtime_error if the file is not an archive or no footer in it checks out.
+    template <typename Read>
+    static std::vector<ArchiveEntry> locate(uint64_t file_size, const Read &read, uint64_t &end, std::vector<Segment> *segments = nullptr)
+    {
+      if (file_size < header_size + footer_size)
+        throw std::runtime_error("Not a game archive.");
+      std::string header = read(0, header_size);
+      if (not detect(header))
+        throw std::runtime_error("Not a game archive.");
+      if (static_cast<uint8_t>(header[4]) != version)
+        throw std::runtime_error("Game archive version " + std::to_string(static_cast<uint8_t>(header[4])) + " is not supported.");
+      try
+      {
+        end = file_size;
+        return readChain(header, file_size, read, segments);
+      }
+      catch (std::runtime_error &torn)
+      {
+        // Scan back for earlier footer magic, a window at a time; any footer that leads to a valid chain will do.
+        const uint64_t window = 1 << 16, lowest = header_size + footer_size;
+        for (uint64_t high = file_size - 1; high >= lowest;)
+        {
+          uint64_t low = high - lowest > window ? high - window : lowest;
+          std::string bytes = read(low - sizeof(footer_magic), high - low + sizeof(footer_magic));
+          for (uint64_t candidate = high; candidate >= low; candidate--)
+          {
+            if (std::memcmp(bytes.data() + (candidate - low), footer_magic, sizeof(footer_magic)) != 0)
+              continue;
+            try
+            {
+              auto entries = readChain(header, candidate, read, segments);
+              end = candidate;
+              return entries;
+            }
+            catch (std::runtime_error &)
+            {
+            }
+          }
+          if (low == lowest)
+            break;
+          high = low - 1;
+        }
+        throw std::runtime_error(torn.what());
+      }
+    }
+  };
+} // namespace GosFrontline
+
+#endif // GAMEARCHIVE_H
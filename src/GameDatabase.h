@@ -0,0 +1,351 @@
+#ifndef GAMEDATABASE_H
+#define GAMEDATABASE_H
+
+/// Read-only, memory-mapped access to a GameArchive for analysis jobs. Games are exposed as
+/// GameView values pointing into the mapping, so scanning an archive copies nothing and parses
+/// only the bytes a job actually looks at; forEach() spreads the games over worker threads.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "GameArchive.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GOSFRONTLINE_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace GosFrontline
+{
+  /// @brief Read-only mapping of a whole file, or a private copy of it where mmap is unavailable.
+  class MappedFile
+  {
+  public:
+    /// @param sequential Hint for the kernel: read ahead for scans, or not for lookups.
+    /// @throws std::runtime_error if @p path cannot be opened or mapped.
+    explicit MappedFile(const std::filesystem::path &path, bool sequential = true)
+    {
+#ifdef GOSFRONTLINE_HAS_MMAP
+      int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd < 0)
+        throw std::runtime_error("Could not open " + path.string() + ".");
+      struct stat info;
+      if (::fstat(fd, &info) != 0)
+      {
+        ::close(fd);
+        throw std::runtime_error("Could not read " + path.string() + ".");
+      }
+      mapped_size = static_cast<size_t>(info.st_size);
+      void *memory = mapped_size > 0 ? ::mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+      ::close(fd);
+      if (memory == MAP_FAILED)
+        throw std::runtime_error("Could not map " + path.string() + ".");
+      ::madvise(memory, mapped_size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+      mapped = static_cast<char *>(memory);
+      data = std::string_view(mapped, mapped_size);
+#else
+      (void)sequential;
+      std::ifstream in(path, std::ios::in | std::ios::binary);
+      owned.resize(std::filesystem::file_size(path));
+      if (not in.read(owned.data(), static_cast<std::streamsize>(owned.size())))
+        throw std::runtime_error("Could not read " + path.string() + ".");
+      data = owned;
+#endif
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile()
+    {
+#ifdef GOSFRONTLINE_HAS_MMAP
+      if (mapped != nullptr)
+        ::munmap(mapped, mapped_size);
+#endif
+    }
+
+    std::string_view bytes() const { return data; }
+
+  private:
+    std::string_view data;
+#ifdef GOSFRONTLINE_HAS_MMAP
+    char *mapped = nullptr;
+    size_t mapped_size = 0;
+#else
+    std::string owned;
+#endif
+  };
+
+  /// @brief One move of a stored game.
+  struct StoredMove
+  {
+    int row, col;
+    PieceType side;
+  };
+
+  /// @brief The move list of a stored game, decoded one varint at a time straight from the mapped file.
+  class MoveSpan
+  {
+  public:
+    class iterator
+    {
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = StoredMove;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const StoredMove *;
+      using reference = const StoredMove &;
+
+      iterator() = default;
+
+      reference operator*() const { return move; }
+      pointer operator->() const { return &move; }
+
+      iterator &operator++()
+      {
+        ply++;
+        decode();
+        return *this;
+      }
+
+      iterator operator++(int)
+      {
+        iterator old = *this;
+        ++*this;
+        return old;
+      }
+
+      bool operator==(const iterator &other) const { return ply == other.ply; }
+      bool operator!=(const iterator &other) const { return ply != other.ply; }
+
+    private:
+      friend class MoveSpan;
+
+      const uint8_t *at = nullptr, *limit = nullptr;
+      size_t ply = 0, count = 0;
+      int cols = 1;
+      uint32_t squares = 0;
+      StoredMove move{0, 0, PieceType::None};
+
+      iterator(const uint8_t *at, const uint8_t *limit, size_t ply, size_t count, int cols, uint32_t squares)
+          : at(at), limit(limit), ply(ply), count(count), cols(cols), squares(squares)
+      {
+        decode();
+      }
+
+      /// @throws std::runtime_error if the record ends early or a move is off the board.
+      void decode()
+      {
+        if (ply >= count)
+          return;
+        uint32_t square = 0;
+        for (int shift = 0;; shift += 7)
+        {
+          if (at >= limit or shift > 28)
+            throw std::runtime_error("Stored game has a malformed move list.");
+          uint8_t b = *at++;
+          square |= static_cast<uint32_t>(b & 0x7F) << shift;
+          if (not(b & 0x80))
+            break;
+        }
+        if (square >= squares)
+          throw std::runtime_error("Stored game has a move off the board.");
+        move = {static_cast<int>(square / cols), static_cast<int>(square % cols), (ply % 2 == 0) ? PieceType::Sente : PieceType::Gote};
+      }
+    };
+
+    MoveSpan() = default;
+    MoveSpan(const uint8_t *data, const uint8_t *limit, size_t count, int rows, int cols)
+        : data(data), limit(limit), count(count), cols(cols), squares(static_cast<uint32_t>(rows * cols)) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    iterator begin() const { return iterator(data, limit, 0, count, cols, squares); }
+    iterator end() const
+    {
+      iterator it;
+      it.ply = count;
+      return it;
+    }
+
+    std::vector<StoredMove> toVector() const { return std::vector<StoredMove>(begin(), end()); }
+
+  private:
+    const uint8_t *data = nullptr, *limit = nullptr;
+    size_t count = 0;
+    int cols = 1;
+    uint32_t squares = 0;
+  };
+
+  /// @brief A stored game inside a GameDatabase. Valid as long as the database is open.
+  struct GameView
+  {
+    size_t id = 0;                       // Position in the archive
+    const ArchiveEntry *entry = nullptr; // Index line: hash, result, names
+    int rows = 0, cols = 0;
+    PieceType engine = PieceType::None;
+    std::string_view sente, gote;
+    MoveSpan moves;
+    std::string_view record; // The whole BinarySave record
+
+    /// @brief Full decode into a Gaming, for jobs that need the rules engine.
+    Gaming toGaming() const { return BinarySave::decode(record); }
+  };
+
+  /// @brief Memory-mapped, read-only GameArchive. Every const member is safe to call from many threads.
+  /// @note Where mmap is unavailable the file is read into memory once instead.
+  class GameDatabase
+  {
+  public:
+    /// @throws std::runtime_error if @p path cannot be mapped or is not a closed archive.
+    explicit GameDatabase(const std::filesystem::path &path)
+        : file(path), data(file.bytes())
+    {
+      uint64_t end = 0;
+      index = GameArchive::locate(data.size(), [this](uint64_t offset, size_t length)
+                                  {
+                                    if (offset > data.size() or length > data.size() - offset)
+                                      throw std::runtime_error("Game archive is truncated.");
+                                    return std::string(data.substr(offset, length)); },
+                                  end);
+    }
+
+    GameDatabase(const GameDatabase &) = delete;
+    GameDatabase &operator=(const GameDatabase &) = delete;
+
+    size_t size() const { return index.size(); }
+    const std::vector<ArchiveEntry> &entries() const { return index; }
+
+    /// @brief The mapped file, for jobs that want to hash or copy whole records.
+    std::string_view bytes() const { return data; }
+
+    /// @brief Locate game @p i inside the mapping. Reads the record header only; moves decode as they are iterated.
+    /// @param verify Also check the record's CRC-32, which touches every byte of it.
+    /// @throws std::runtime_error if the record is damaged.
+    GameView view(size_t i, bool verify = false) const
+    {
+      const ArchiveEntry &e = index.at(i);
+      std::string_view record = data.substr(e.offset, e.length);
+      if (not BinarySave::detect(record) or record.size() < sizeof(BinarySave::magic) + 6 + 4)
+        throw std::runtime_error("Game " + std::to_string(i + 1) + " is not a binary save record.");
+      if (verify)
+      {
+        uint32_t stored = 0;
+        for (int b = 0; b < 4; b++)
+          stored |= static_cast<uint32_t>(static_cast<uint8_t>(record[record.size() - 4 + b])) << (8 * b);
+        if (BinarySave::crc32(record.data(), record.size() - 4) != stored)
+          throw std::runtime_error("Game " + std::to_string(i + 1) + " is corrupt: checksum mismatch.");
+      }
+
+      BinarySave::Reader in{record.substr(0, record.size() - 4), sizeof(BinarySave::magic)};
+      if (in.byte() != BinarySave::version)
+        throw std::runtime_error("Game " + std::to_string(i + 1) + " has an unsupported version.");
+      in.byte(); // flags; a board snapshot after the moves is not needed here
+      GameView view;
+      view.id = i;
+      view.entry = &e;
+      view.rows = in.byte();
+      view.cols = in.byte();
+      int engine = in.byte();
+      in.byte(); // reserved
+      if (view.rows == 0 or view.cols == 0 or engine > 2)
+        throw std::runtime_error("Game " + std::to_string(i + 1) + " has invalid board parameters.");
+      view.engine = static_cast<PieceType>(engine);
+      view.sente = in.bytes(static_cast<size_t>(in.varint()));
+      view.gote = in.bytes(static_cast<size_t>(in.varint()));
+      in.varint(); // saved-at time
+      uint64_t count = in.varint();
+      if (count > static_cast<uint64_t>(view.rows) * view.cols)
+        throw std::runtime_error("Game " + std::to_string(i + 1) + " has more moves than squares.");
+      auto begin = reinterpret_cast<const uint8_t *>(in.data.data() + in.at);
+      auto limit = reinterpret_cast<const uint8_t *>(in.data.data() + in.data.size());
+      view.moves = MoveSpan(begin, limit, static_cast<size_t>(count), view.rows, view.cols);
+      view.record = record;
+      return view;
+    }
+
+    /// @brief Call @p fn(const GameView &) for every game, from @p threads workers (all cores if 0).
+    ///        Games are handed out in blocks of consecutive ids so each worker reads the file mostly
+    ///        sequentially; the order of calls across workers is unspecified, so @p fn must be thread-safe.
+    ///        The first exception thrown by @p fn or view() stops the scan and is rethrown here.
+    template <class Fn>
+    void forEach(Fn &&fn, unsigned threads = 0, bool verify = false) const
+    {
+      forEachId([this, &fn, verify](size_t i)
+                { fn(view(i, verify)); },
+                threads);
+    }
+
+    /// @brief As forEach(), but @p fn receives only the game id, for jobs that call view() themselves
+    ///        to deal with damaged records one by one.
+    template <class Fn>
+    void forEachId(Fn &&fn, unsigned threads = 0) const
+    {
+      const size_t block = 256;
+      if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+      threads = static_cast<unsigned>(std::min<size_t>(threads, (index.size() + block - 1) / block));
+      std::atomic<size_t> next{0};
+      std::atomic<bool> failed{false};
+      std::exception_ptr error;
+      std::mutex error_mutex;
+
+      auto work = [&]()
+      {
+        try
+        {
+          for (size_t first = next.fetch_add(block); first < index.size() and not failed.load(std::memory_order_relaxed);
+               first = next.fetch_add(block))
+          {
+            for (size_t i = first; i < std::min(first + block, index.size()); i++)
+              fn(i);
+          }
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> lock(error_mutex);
+          if (not error)
+            error = std::current_exception();
+          failed.store(true);
+        }
+      };
+
+      if (threads <= 1)
+      {
+        work();
+      }
+      else
+      {
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; t++)
+          workers.emplace_back(work);
+        for (auto &worker : workers)
+          worker.join();
+      }
+      if (error)
+        std::rethrow_exception(error);
+    }
+
+  private:
+    MappedFile file;
+    std::string_view data;
+    std::vector<ArchiveEntry> index;
+  };
+} // namespace GosFrontline
+
+#endif // GAMEDATABASE_H
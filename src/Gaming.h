@@ -614,7 +614,7 @@ namespace GosFrontline
       return board.at(row, col) == PieceType::None;
     }
 
-    PieceType engineSide()
+    PieceType engineSide() const
     {
       return engine;
     }
@@ -67,12 +67,17 @@ namespace GosFrontline
 
     void printWelcome() const;
     void printMenu() const;
-    void printBoard() const;
+    void printBoard();
+    void syncBoard();
+    void resyncBoard();
     void printMsg(const std::string &, Color) const;
+    void printEngineInfo();
     void quit();
     void undo();
     void save();
     bool readGame();
+    bool resumeGame();
+    std::optional<size_t> pickArchiveGame(const std::string &path);
     std::pair<int, int> getNumbers(std::string);
     std::string getInput(std::string prompt, std::string fallback);
     void printBadInput() const;
@@ -82,6 +87,7 @@ namespace GosFrontline
     static const std::string default_size, game_over_prompt, filename_prompt_save, ask_side;
     std::string save_location = "./saved_games";
     std::string autosave_file = "autosave.gfl";
+    std::string journal_file = "autosave.gflj"; // Backend's journal of the game in progress
     static const int timeout; // millisecond timeout
     bool game_over;
     bool pve;
@@ -92,6 +98,12 @@ namespace GosFrontline
     std::function<Backend &()> backend = []() -> Backend &
     { return Backend::getBackend(); };
 
+    // Local copy of the board, kept in step with the backend by applying its deltas.
+    std::shared_ptr<DeltaSubscription> updates;
+    std::vector<std::vector<PieceType>> board;
+    int board_step = 0;
+    uint64_t board_sequence = 0;
+
     std::vector<std::string> input_history{};
     std::shared_ptr<Logger> logger;
     std::stringstream logstream;
@@ -136,7 +148,8 @@ namespace GosFrontline
                     InterfaceCLI::ask_board_size = "Please enter the size of the board in form (row col): (Press enter to default to 15*15 board)",
                     InterfaceCLI::default_size = "Did not get a valid input! Defaulting to 15*15\n",
                     InterfaceCLI::filename_prompt_save = "Please enter the name of the file you wish to save to:"
-                                                         "\n(Entering nothing will result in saving to a default file, enter name to save to a custom file) ",
+                                                         "\n(Entering nothing will result in saving to a default file, enter name to save to a custom file,"
+                                                         "\n end the name with .gflb for a compact binary save, or with .gfla to add the game to an archive) ",
                     InterfaceCLI::ask_side = "Which side would you like to play, \e[4mS\e[0mente or \e[4mG\e[0mote? ",
                     InterfaceCLI::main_quit = "Thank you for using this program! Hit any key to close this window.";
 
@@ -216,24 +229,72 @@ namespace GosFrontline
     std::cout << bad_input;
   }
 
-  void InterfaceCLI::printBoard() const
+  /// @brief Bring the local board up to date from the deltas received since the last call. The
+  ///        backend publishes a move's deltas before replying to it, so after a move reply no round
+  ///        trip is needed. After newGame, callEngine, loadGame or an undo the backend may still be
+  ///        working, so those paths call resyncBoard() instead, which is queued behind them.
+  void InterfaceCLI::syncBoard()
   {
-    auto board_future = backend().getBoard();
-    std::pair<std::vector<std::vector<PieceType>>, int> board = board_future.get();
+    if (not updates)
+      resyncBoard();
+    while (auto delta = updates->next())
+    {
+      if (delta->sequence <= board_sequence)
+        continue; // Already part of the snapshot
+      if (delta->sequence != board_sequence + 1)
+      {
+        logger->log("Missed board updates. Fetching the whole board.", MessageType::WARNING);
+        resyncBoard();
+        continue;
+      }
+      board_sequence = delta->sequence;
+      switch (delta->kind)
+      {
+      case GameDelta::Kind::Placed:
+        board[delta->row][delta->col] = delta->side;
+        board_step++;
+        break;
+      case GameDelta::Kind::Undone:
+        board[delta->row][delta->col] = PieceType::None;
+        board_step--;
+        break;
+      case GameDelta::Kind::Reset:
+        board.assign(delta->rows, std::vector<PieceType>(delta->cols, PieceType::None));
+        board_step = 0;
+        break;
+      case GameDelta::Kind::Result:
+        break; // The game loop judges wins from move replies
+      }
+    }
+  }
 
-    std::cout << "Such was the board after move " << board.second << "\n";
+  void InterfaceCLI::resyncBoard()
+  {
+    if (not updates)
+      updates = backend().subscribe(); // Before the snapshot, so nothing after it is missed
+    SnapshotPtr snapshot = backend().getBoard().get();
+    board = snapshot->board();
+    board_step = snapshot->step();
+    board_sequence = snapshot->sequence;
+  }
+
+  void InterfaceCLI::printBoard()
+  {
+    syncBoard();
 
-    for (size_t i = 0; i < board.first[0].size(); i++)
+    std::cout << "Such was the board after move " << board_step << "\n";
+
+    for (size_t i = 0; i < board[0].size(); i++)
     {
       std::cout << std::setw(2) << std::left << i + 1;
     }
     std::cout << std::endl;
-    for (int i = 0; i < board.first.size(); ++i)
+    for (size_t i = 0; i < board.size(); ++i)
     {
 
-      for (int j = 0; j < board.first[i].size(); ++j)
+      for (size_t j = 0; j < board[i].size(); ++j)
       {
-        switch (board.first.at(i).at(j))
+        switch (board.at(i).at(j))
         {
         case PieceType::None:
           std::cout << "_ ";
@@ -280,14 +341,23 @@ namespace GosFrontline
     {
       std::filesystem::create_directory(save_location);
     }
-    std::string file_path = save_location + std::string("/") + GosFrontline::sanitize_filename(input) + ".gfl";
+    // A name ending in .gflb asks for the compact binary format and .gfla appends to an archive;
+    // anything else is saved as .gfl text.
+    std::string name = GosFrontline::sanitize_filename(input);
+    auto ends_with = [&name](const std::string &extension)
+    {
+      return name.size() > extension.size() and name.compare(name.size() - extension.size(), extension.size(), extension) == 0;
+    };
+    bool archive = ends_with(GameArchive::extension);
+    bool keep_name = archive or ends_with(BinarySave::extension);
+    std::string file_path = save_location + std::string("/") + name + (keep_name ? "" : ".gfl");
 
     logstream.str("");
     logstream << "Saving to " << file_path << "";
     logger->log(logstream.str());
     logstream.str("");
 
-    if (std::filesystem::exists(file_path))
+    if (not archive and std::filesystem::exists(file_path))
     {
       while (1)
       {
@@ -319,7 +389,16 @@ namespace GosFrontline
     }
     else if (response == std::future_status::ready)
     {
-      printMsg("Saved to " + file_path, Color::Green);
+      try
+      {
+        reply.get();
+        printMsg("Saved to " + file_path, Color::Green);
+      }
+      catch (std::runtime_error &e)
+      {
+        printMsg(std::string("Save failed: ") + e.what(), Color::Red);
+        logger->log("Backend could not write the save.", MessageType::WARNING);
+      }
     }
   }
 
@@ -363,6 +442,20 @@ namespace GosFrontline
     std::cout << "\e[0m";
   }
 
+  /// @brief Show the latest engine search report, like a UCI "info" line, and drop older ones.
+  void InterfaceCLI::printEngineInfo()
+  {
+    std::optional<SearchInfo> latest;
+    while (auto info = backend().nextSearchInfo())
+    {
+      latest = std::move(info);
+    }
+    if (latest)
+    {
+      printMsg("Engine " + latest->toString(), Color::Blue);
+    }
+  }
+
   bool InterfaceCLI::readGame()
   {
     clearScreen();
@@ -402,11 +495,104 @@ namespace GosFrontline
         continue;
       }
     }
-    auto reply = backend().loadGame(save_location + std::string("/") + toload);
+    std::optional<size_t> entry;
+    if (std::filesystem::path(toload).extension() == GameArchive::extension)
+    {
+      entry = pickArchiveGame(save_location + std::string("/") + toload);
+      if (not entry)
+        return false;
+    }
+    auto reply = backend().loadGame(save_location + std::string("/") + toload, entry);
     reply.wait();
     return reply.get();
   }
 
+  /// @brief Point the backend's journal into the save folder, and offer to resume the game it holds
+  ///        if the last session ended before that game was finished.
+  /// @return Whether a game was resumed.
+  bool InterfaceCLI::resumeGame()
+  {
+    if (not std::filesystem::exists(save_location))
+    {
+      std::filesystem::create_directory(save_location);
+    }
+    std::string journal_path = save_location + std::string("/") + journal_file;
+    int moves = 0;
+    try
+    {
+      std::string data(std::filesystem::file_size(journal_path), '\0');
+      std::ifstream in(journal_path, std::ios::in | std::ios::binary);
+      if (in.read(data.data(), static_cast<std::streamsize>(data.size())))
+      {
+        ReplayReport report = ReplayVerifier::verify(MoveJournal::decode(data));
+        if (report.ok() and report.winner == PieceType::None)
+          moves = report.moves;
+      }
+    }
+    catch (std::exception &) // No journal yet, or nothing usable in it
+    {
+    }
+    backend().setJournal(journal_path); // Only written once a game starts, so it is read first
+
+    if (moves == 0)
+      return false;
+    logger->log("Found an unfinished game in the autosave journal.");
+    auto answer = getInput("Your last game was not finished (" + std::to_string(moves) + " moves). Resume it? (y/n) ");
+    if (answer.empty() or std::tolower(answer[0]) != 'y')
+      return false;
+    auto reply = backend().loadGame(journal_path);
+    reply.wait();
+    if (not reply.get())
+    {
+      printMsg("Could not resume the last game.", Color::Red);
+      logger->log("Resuming from the autosave journal failed.", MessageType::ERROR);
+      return false;
+    }
+    logger->log("Resumed the game from the autosave journal.");
+    return true;
+  }
+
+  /// @brief List the games in an archive from its index alone and ask which one to load.
+  std::optional<size_t> InterfaceCLI::pickArchiveGame(const std::string &path)
+  {
+    std::vector<ArchiveEntry> games;
+    try
+    {
+      games = GameArchive(path).entries();
+    }
+    catch (std::runtime_error &e)
+    {
+      logger->log(std::string("Could not open archive: ") + e.what(), MessageType::ERROR);
+      return std::nullopt;
+    }
+    if (games.empty())
+      return std::nullopt;
+    const char *results[] = {"unfinished", "Sente won", "Gote won", "draw"};
+    clearScreen();
+    while (true)
+    {
+      printMsg("Games in " + path + ":");
+      for (size_t i = 0; i < games.size(); i++)
+      {
+        printMsg(std::to_string(i + 1) + ". " + games[i].sente + " vs " + games[i].gote + ", " +
+                 std::to_string(games[i].moves) + " moves, " + results[static_cast<int>(games[i].result) & 3]);
+      }
+      std::string ipt = getInput("Which game would you like to load? (Enter number) ");
+      int sequence = 0;
+      try
+      {
+        sequence = std::stoi(ipt);
+      }
+      catch (std::exception &e)
+      {
+      }
+      if (sequence >= 1 and sequence <= static_cast<int>(games.size()))
+        return static_cast<size_t>(sequence - 1);
+      clearScreen();
+      printMsg("Invalid input. Please enter a number within the range of " + std::to_string(games.size()) + ".", Color::Red);
+    }
+  }
+
   void
   InterfaceCLI::run()
   {
@@ -418,6 +604,15 @@ namespace GosFrontline
     logstream.str("");
 
     std::string current_prompt = menu_prompt;
+    if (resumeGame())
+    {
+      position = CurrentState::InGame;
+      current_prompt = game_prompt;
+      game_over = false;
+      pve = backend().getGame().get()->game.engineSide() != PieceType::None; // The journal records engine switches
+      resyncBoard();
+      printBoard();
+    }
     while (not exit)
     {
       std::string input = getInput(current_prompt);
@@ -498,6 +693,7 @@ namespace GosFrontline
             backend().callEngine();
           }
 
+          resyncBoard(); // Queued behind newGame and the engine's opening move
           printBoard();
           position = CurrentState::InGame;
           current_prompt = game_prompt;
@@ -509,6 +705,7 @@ namespace GosFrontline
           {
           position = CurrentState::InGame;
            logger->log("Read game successful!");
+           resyncBoard(); // Also waits for the engine's reply if it is to move
            printBoard();
            current_prompt = game_prompt;
            game_over = false;
@@ -648,6 +845,7 @@ namespace GosFrontline
                 {
                   logger->log("AI move has finished. Now outputting board.", MessageType::DEBUG);
                   printBoard();
+                  printEngineInfo();
                 }
               }
             }
@@ -720,6 +918,7 @@ namespace GosFrontline
             }
             clearScreen();
             undo();
+            resyncBoard(); // The engine may replay its opening move after the undo
             printBoard();
 
             break;
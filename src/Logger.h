@@ -1,12 +1,25 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
 #include <fstream>
 #include <sstream>
 #include <chrono>
+#include <algorithm>
+#include <cstdlib>
 #include <filesystem>
+#include <future>
+#include <mutex>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <type_traits>
 
-#include "SafeQueue.h"
+#include "MPSCQueue.h"
+#include "BinaryLog.h"
 
 namespace GosFrontline
 {
@@ -19,32 +32,224 @@ namespace GosFrontline
         FATAL
     };
 
+    /// @brief Typed fields attached to a log line. They are stored as-is and only turned
+    ///        into text by the writer thread. Unset fields are left out of the line.
+    struct LogFields
+    {
+        int row = -1, col = -1;         // Move coordinates
+        long long latency_us = -1;      // How long the logged operation took
+        std::thread::id thread{};       // Default id means "not recorded"
+
+        static LogFields move(int r, int c)
+        {
+            LogFields fields;
+            fields.row = r;
+            fields.col = c;
+            return fields;
+        }
+
+        LogFields &onThisThread()
+        {
+            thread = std::this_thread::get_id();
+            return *this;
+        }
+
+        LogFields &took(std::chrono::steady_clock::duration elapsed)
+        {
+            latency_us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+            return *this;
+        }
+    };
+
+    class Logger;
+
+    /// @brief When a LogService starts a new file and how much of its log directory it keeps.
+    struct LogRotation
+    {
+        size_t max_file_bytes = 16u << 20;                  // Start a new file past this size
+        std::chrono::minutes max_file_age{24 * 60};         // ... or once a file is this old
+        bool compress = false;                              // gzip rotated files in the background (needs a shell and gzip)
+        size_t max_directory_bytes = 256u << 20;            // Delete the oldest log files past this total; 0 disables
+    };
+
+    /// @brief Asynchronous logging service: one queue, one writer thread and one file set shared
+    ///        by any number of named channels (see Logger). log() only queues the line; the writer
+    ///        batches lines into a buffer and writes it out when it fills up, when flush_interval has
+    ///        passed, on FATAL, on flush() and on destruction.
+    class LogService : public std::enable_shared_from_this<LogService>
+    {
+    public:
+        static const size_t max_channels = 32;
+
+        LogService(std::string fileName);
+        LogService(std::string fileName, std::string pathName);
+        ~LogService();
+
+        std::shared_ptr<Logger> channel(const std::string &name);
+        size_t channelId(const std::string &name);
+
+        void log(size_t channel, const std::string &message, MessageType type = MessageType::INFO);
+        template <typename... Args>
+        void logf(size_t channel, MessageType type, const LogFields &fields, std::string_view format, const Args &...args);
+
+        bool enabled(size_t channel, MessageType type) const;
+        void setEnabled(size_t channel, MessageType type, bool on);
+        void setEnabled(const std::string &channel, MessageType type, bool on);
+
+        void setRotation(const LogRotation &rotation);
+        bool enableBinarySink(size_t capacity = 1 << 16);
+        std::string getBinaryFileName() const;
+
+        void flush();
+        std::string getFileName() const;
+
+    private:
+        static const size_t inline_text = 160;
+
+        struct Record
+        {
+            std::chrono::system_clock::rep ticks = 0;     // Raw timestamp, rendered by the writer
+            MessageType type = MessageType::INFO;
+            uint8_t channel = 0;
+            uint16_t length = 0;                          // Bytes used in text
+            std::array<char, inline_text> text;           // Short messages live here, no allocation
+            std::string long_text;                        // Only for messages that do not fit in text
+            LogFields fields;
+            bool urgent = false;                          // Write out immediately (FATAL)
+            std::shared_ptr<std::promise<void>> flushed;  // Fulfilled once everything up to here is on disk
+            bool stop = false;                            // Last record; the writer exits after it
+        };
+
+        void startWriter();
+        void writerLoop();
+        void write(const std::string &buffer);
+        void rotate();
+        void enforceRetention();
+        std::string freshFileName() const;
+        void enqueue(Record &&record);
+        void render(const Record &record, std::string &buffer) const;
+
+        static void appendText(char *&out, char *end, std::string_view text)
+        {
+            size_t n = std::min(text.size(), static_cast<size_t>(end - out));
+            std::copy(text.data(), text.data() + n, out);
+            out += n;
+        }
+
+        template <typename T>
+        static void appendArg(char *&out, char *end, const T &value)
+        {
+            if constexpr (std::is_same_v<T, bool>)
+            {
+                appendText(out, end, value ? "true" : "false");
+            }
+            else if constexpr (std::is_integral_v<T> or std::is_floating_point_v<T>)
+            {
+                auto result = std::to_chars(out, end, value);
+                out = (result.ec == std::errc()) ? result.ptr : end;
+            }
+            else if constexpr (std::is_enum_v<T>)
+            {
+                appendArg(out, end, static_cast<std::underlying_type_t<T>>(value));
+            }
+            else
+            {
+                appendText(out, end, std::string_view(value));
+            }
+        }
+
+        static char *formatInto(char *out, char *end, std::string_view format)
+        {
+            appendText(out, end, format);
+            return out;
+        }
+
+        template <typename First, typename... Rest>
+        static char *formatInto(char *out, char *end, std::string_view format, const First &first, const Rest &...rest)
+        {
+            size_t hole = format.find("{}");
+            if (hole == std::string_view::npos)
+            {
+                return formatInto(out, end, format);
+            }
+            appendText(out, end, format.substr(0, hole));
+            appendArg(out, end, first);
+            return formatInto(out, end, format.substr(hole + 2), rest...);
+        }
+
+        std::string fileName, pathName;
+        std::string filePrefix;            // Directory and base name shared by every file of this logger
+        mutable std::mutex m_file_mutex;   // Guards fileName, binaryFileName and m_rotation
+        std::ofstream m_file;
+        LogRotation m_rotation;
+        size_t m_file_bytes = 0;                               // Writer thread only
+        std::chrono::steady_clock::time_point m_file_opened;   // Writer thread only
+        std::future<void> m_compression;                       // Writer thread only
+        static const size_t queue_capacity = 1 << 12;
+        static const size_t buffer_size = 1 << 16;                           // Bytes gathered before a write
+        static constexpr std::chrono::milliseconds flush_interval{200};     // Longest a line waits in the buffer
+        BoundedMPSCQueue<Record> m_queue{queue_capacity}; // Any thread logs, only the writer thread pops
+        std::atomic<size_t> m_dropped{0};                  // Messages lost to a full queue since the last drain
+        std::array<std::atomic<unsigned>, max_channels> m_enabled; // Bit per MessageType, per channel
+        std::array<std::string, max_channels> m_channel_names;    // Written once, before the id is published
+        std::atomic<size_t> m_channel_count{0};
+        std::mutex m_channel_mutex;                                // Serialises registering channels
+        std::unique_ptr<BinaryLogSink> m_binary_owner;
+        std::atomic<BinaryLogSink *> m_binary{nullptr}; // When set, logf() records go here instead of the text file
+        std::string binaryFileName;
+        std::thread m_writer;
+        static const std::vector<std::string> types;
+    };
+
+    /// @brief A named channel of a LogService. Every component holds its own Logger, while all of
+    ///        them share one queue, one writer thread and one file. A Logger built from a file name
+    ///        owns a private service with a single unnamed channel, as before channels existed.
     class Logger
     {
     public:
         Logger(std::string fileName);
         Logger(std::string fileName, std::string pathName);
-        ~Logger();
+        Logger(std::shared_ptr<LogService> service, const std::string &channel);
+
+        std::shared_ptr<Logger> channel(const std::string &name) const;
+        std::shared_ptr<LogService> getService() const;
+
+        void log(const std::string &message, MessageType type = MessageType::INFO);
 
-        void log(const std::string &message, MessageType type);
-        void infinite_run();
+        /// @brief Formatted logging. Each "{}" in @p format is replaced by the next argument
+        ///        (integers, floating point, bool, enums, strings). Nothing is formatted unless
+        ///        @p type is enabled, and short lines are built without touching the heap.
+        template <typename... Args>
+        void logf(MessageType type, std::string_view format, const Args &...args)
+        {
+            service->logf(id, type, LogFields(), format, args...);
+        }
+        template <typename... Args>
+        void logf(MessageType type, const LogFields &fields, std::string_view format, const Args &...args)
+        {
+            service->logf(id, type, fields, format, args...);
+        }
+
+        bool enabled(MessageType type) const;
+        void setEnabled(MessageType type, bool on);
+
+        void setRotation(const LogRotation &rotation);
+        bool enableBinarySink(size_t capacity = 1 << 16);
+        std::string getBinaryFileName() const;
+
+        void flush();
         void run();
-        void setEndFlag();
         std::string getFileName() const;
 
     private:
-        void write(const std::string &message);
-        std::string fileName, pathName;
-        std::ofstream m_file;
-        SafeQueue<std::string> m_queue;
-        static const std::vector<std::string> types;
-        bool endFlag = false;
+        std::shared_ptr<LogService> service;
+        size_t id;
     };
 } // namespace GosFrontline
 
-const std::vector<std::string> GosFrontline::Logger::types = {"INFO", "WARNING", "ERROR", "DEBUG", "FATAL"};
+const std::vector<std::string> GosFrontline::LogService::types = {"INFO", "WARNING", "ERROR", "DEBUG", "FATAL"};
 
-GosFrontline::Logger::Logger(std::string fn)
+GosFrontline::LogService::LogService(std::string fn)
 {
     pathName = "log/";
     fileName = fn;
@@ -52,11 +257,13 @@ GosFrontline::Logger::Logger(std::string fn)
     {
         std::filesystem::create_directory(std::filesystem::path(pathName));
     }
-    fileName = "log/" + fn + "_" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count() / 1000000) + ".log";
+    filePrefix = "log/" + fn;
+    fileName = freshFileName();
     m_file.open(fileName, std::ios::out | std::ios::app);
+    startWriter();
 }
 
-GosFrontline::Logger::Logger(std::string fn, std::string pn)
+GosFrontline::LogService::LogService(std::string fn, std::string pn)
 {
     this->pathName = pn;
     this->fileName = fn;
@@ -64,66 +271,492 @@ GosFrontline::Logger::Logger(std::string fn, std::string pn)
     {
         std::filesystem::create_directory(std::filesystem::path(pathName));
     }
-    fileName = pn + "/" + fn + "_" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count() / 1000000) + ".log";
+    filePrefix = pn + "/" + fn;
+    fileName = freshFileName();
     m_file.open(fileName, std::ios::out | std::ios::app);
+    startWriter();
 }
 
-GosFrontline::Logger::~Logger()
+GosFrontline::LogService::~LogService()
 {
+    Record last;
+    last.stop = true;
+    m_queue.push(std::move(last));
+    m_writer.join();
     m_file.close();
+    if (m_compression.valid())
+        m_compression.wait();
+}
+
+void GosFrontline::LogService::startWriter()
+{
+    for (auto &mask : m_enabled)
+    {
+#ifdef DEBUG
+        mask.store(~0u);
+#else
+        mask.store(~(1u << static_cast<int>(MessageType::DEBUG)));
+#endif
+    }
+    m_file_opened = std::chrono::steady_clock::now();
+    m_writer = std::thread([this]()
+                           { writerLoop(); });
 }
 
-void GosFrontline::Logger::log(const std::string &message, MessageType type = MessageType::INFO)
+void GosFrontline::LogService::log(size_t channel, const std::string &message, MessageType type)
 {
-#ifndef DEBUG
-    if (type == MessageType::DEBUG)
+    if (not enabled(channel, type))
     {
         return;
     }
-#endif
-    m_queue.push(std::to_string(std::chrono::system_clock::now().time_since_epoch().count() / 1000000) + " " + types[static_cast<int>(type)] + " | " + message);
+    Record record;
+    record.type = type;
+    record.channel = static_cast<uint8_t>(channel);
+    if (message.size() <= inline_text)
+    {
+        std::copy(message.begin(), message.end(), record.text.begin());
+        record.length = static_cast<uint16_t>(message.size());
+    }
+    else
+    {
+        record.long_text = message;
+    }
+    enqueue(std::move(record));
+}
+
+template <typename... Args>
+void GosFrontline::LogService::logf(size_t channel, MessageType type, const LogFields &fields, std::string_view format, const Args &...args)
+{
+    if (not enabled(channel, type))
+    {
+        return;
+    }
+    if (BinaryLogSink *sink = m_binary.load(std::memory_order_acquire))
+    {
+        sink->write(static_cast<int>(type), m_channel_names[channel], fields.row, fields.col, fields.latency_us, fields.thread, format, args...);
+        if (type != MessageType::FATAL) // FATAL also goes to the text file so it is never missed
+            return;
+    }
+    thread_local std::array<char, 4096> scratch; // Per-thread, so formatting never allocates or contends
+    char *end = formatInto(scratch.data(), scratch.data() + scratch.size(), format, args...);
+    size_t length = static_cast<size_t>(end - scratch.data());
+
+    Record record;
+    record.type = type;
+    record.channel = static_cast<uint8_t>(channel);
+    record.fields = fields;
+    if (length <= inline_text)
+    {
+        std::copy(scratch.data(), end, record.text.begin());
+        record.length = static_cast<uint16_t>(length);
+    }
+    else
+    {
+        record.long_text.assign(scratch.data(), length);
+    }
+    enqueue(std::move(record));
 }
 
-void GosFrontline::Logger::infinite_run()
+void GosFrontline::LogService::enqueue(Record &&record)
 {
-    while (true)
+    record.ticks = std::chrono::system_clock::now().time_since_epoch().count();
+    if (record.type == MessageType::FATAL)
+    {
+        record.urgent = true;
+        m_queue.push(std::move(record)); // Never lose the last words; wait for room instead.
+    }
+    else if (not m_queue.try_push(std::move(record)))
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/// @brief Send logf() records to a memory-mapped binary ring next to the text log
+///        (decode with tools/glog_decode). Plain log() calls keep going to the text file.
+/// @param capacity Records kept in the ring before the oldest are overwritten.
+/// @return false if the binary file could not be set up; text logging continues either way.
+bool GosFrontline::LogService::enableBinarySink(size_t capacity)
+{
+    if (m_binary.load() != nullptr)
+        return true;
+    std::string current = getFileName();
+    std::string path = current.substr(0, current.size() - std::string(".log").size()) + ".glog";
+    try
+    {
+        m_binary_owner = std::make_unique<BinaryLogSink>(path, capacity);
+    }
+    catch (std::runtime_error &e)
     {
-        if (m_queue.empty())
+        log(channelId(""), std::string("Binary log sink unavailable: ") + e.what(), MessageType::WARNING);
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_file_mutex);
+        binaryFileName = path;
+    }
+    m_binary.store(m_binary_owner.get(), std::memory_order_release);
+    return true;
+}
+
+std::string GosFrontline::LogService::getBinaryFileName() const
+{
+    std::lock_guard<std::mutex> lock(m_file_mutex);
+    return binaryFileName;
+}
+
+bool GosFrontline::LogService::enabled(size_t channel, MessageType type) const
+{
+    return (m_enabled[channel].load(std::memory_order_relaxed) >> static_cast<int>(type)) & 1u;
+}
+
+/// @brief Switch one message type of one channel on or off at runtime.
+void GosFrontline::LogService::setEnabled(size_t channel, MessageType type, bool on)
+{
+    if (on)
+        m_enabled[channel].fetch_or(1u << static_cast<int>(type), std::memory_order_relaxed);
+    else
+        m_enabled[channel].fetch_and(~(1u << static_cast<int>(type)), std::memory_order_relaxed);
+}
+
+void GosFrontline::LogService::setEnabled(const std::string &channel, MessageType type, bool on)
+{
+    setEnabled(channelId(channel), type, on);
+}
+
+/// @brief Id of the channel called @p name, registering it on first use.
+/// @throws std::length_error past max_channels channels.
+size_t GosFrontline::LogService::channelId(const std::string &name)
+{
+    size_t count = m_channel_count.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (m_channel_names[i] == name)
+            return i;
+    }
+    std::lock_guard<std::mutex> lock(m_channel_mutex);
+    count = m_channel_count.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (m_channel_names[i] == name)
+            return i;
+    }
+    if (count == max_channels)
+        throw std::length_error("Too many log channels.");
+    m_channel_names[count] = name;
+    m_channel_count.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+/// @brief Turn a record into one text line: "<ms> <TYPE> [Channel] | <message> {fields}".
+///        The channel tag is left out for the unnamed channel of a standalone Logger.
+void GosFrontline::LogService::render(const Record &record, std::string &buffer) const
+{
+    using namespace std::chrono;
+    buffer += std::to_string(duration_cast<milliseconds>(system_clock::duration(record.ticks)).count());
+    buffer += ' ';
+    buffer += types[static_cast<int>(record.type)];
+    const std::string &channel = m_channel_names[record.channel];
+    if (not channel.empty())
+    {
+        buffer += " [";
+        buffer += channel;
+        buffer += ']';
+    }
+    buffer += " | ";
+    if (record.long_text.empty())
+        buffer.append(record.text.data(), record.length);
+    else
+        buffer += record.long_text;
+
+    const LogFields &f = record.fields;
+    if (f.row >= 0 or f.latency_us >= 0 or f.thread != std::thread::id())
+    {
+        std::ostringstream fields;
+        if (f.row >= 0)
+            fields << " move=(" << f.row << ", " << f.col << ")";
+        if (f.thread != std::thread::id())
+            fields << " thread=" << f.thread;
+        if (f.latency_us >= 0)
+            fields << " latency_us=" << f.latency_us;
+        buffer += " {" + fields.str().substr(1) + "}";
+    }
+    buffer += '\n';
+}
+
+/// @brief Blocks until every message logged before this call has been written to disk.
+void GosFrontline::LogService::flush()
+{
+    Record marker;
+    marker.flushed = std::make_shared<std::promise<void>>();
+    auto done = marker.flushed->get_future();
+    m_queue.push(std::move(marker));
+    done.wait();
+}
+
+void GosFrontline::LogService::writerLoop()
+{
+    std::string buffer;
+    buffer.reserve(buffer_size + 1024);
+    std::vector<std::shared_ptr<std::promise<void>>> waiting;
+    auto last_write = std::chrono::steady_clock::now();
+    bool running = true;
+    enforceRetention(); // Each run starts its own file, so earlier runs' files are pruned here, not only on rotation
+
+    while (running)
+    {
+        // Idle with an empty buffer: sleep until something arrives. Otherwise only until the buffer is due.
+        std::optional<Record> record;
+        if (buffer.empty())
         {
-            if (endFlag)
+            record = m_queue.pop();
+        }
+        else
+        {
+            record = m_queue.pop_for(last_write + flush_interval - std::chrono::steady_clock::now());
+        }
+
+        bool write_now = false;
+        while (record)
+        {
+            size_t dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+            if (dropped > 0)
             {
-                return;
+                buffer += std::to_string(std::chrono::system_clock::now().time_since_epoch().count() / 1000000) + " WARNING | Log queue was full, " + std::to_string(dropped) + " messages dropped.\n";
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            continue;
+            if (record->ticks != 0)
+            {
+                render(*record, buffer);
+            }
+            if (record->flushed)
+            {
+                waiting.push_back(std::move(record->flushed));
+            }
+            write_now = write_now or record->urgent or record->stop or not waiting.empty();
+            running = running and not record->stop;
+
+            if (write_now or buffer.size() >= buffer_size or not running)
+                break;
+            record = m_queue.try_pop();
+        }
+
+        if (write_now or buffer.size() >= buffer_size or std::chrono::steady_clock::now() - last_write >= flush_interval)
+        {
+            write(buffer);
+            buffer.clear();
+            last_write = std::chrono::steady_clock::now();
+            for (auto &promise : waiting)
+            {
+                promise->set_value();
+            }
+            waiting.clear();
         }
-        std::string message = m_queue.pop();
-        write(message);
     }
 }
 
-void GosFrontline::Logger::run()
+void GosFrontline::LogService::write(const std::string &buffer)
 {
-    while (not m_queue.empty())
+    if (not buffer.empty())
     {
-        std::string message = m_queue.pop();
-        write(message);
+        m_file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        m_file_bytes += buffer.size();
     }
+    m_file.flush();
+
+    bool due;
+    {
+        std::lock_guard<std::mutex> lock(m_file_mutex);
+        due = (m_rotation.max_file_bytes != 0 and m_file_bytes >= m_rotation.max_file_bytes) or
+              (m_rotation.max_file_age.count() != 0 and std::chrono::steady_clock::now() - m_file_opened >= m_rotation.max_file_age);
+    }
+    if (due)
+        rotate();
 }
 
-void GosFrontline::Logger::write(const std::string &message)
+std::string GosFrontline::LogService::getFileName() const
 {
-    m_file << message << std::endl;
+    std::lock_guard<std::mutex> lock(m_file_mutex);
+    return fileName;
 }
 
-std::string GosFrontline::Logger::getFileName() const
+/// @brief Change when files are rotated and how much of the log directory is kept.
+void GosFrontline::LogService::setRotation(const LogRotation &rotation)
 {
-    return fileName;
+    std::lock_guard<std::mutex> lock(m_file_mutex);
+    m_rotation = rotation;
+}
+
+/// @brief "<prefix>_<ms>.log", with a counter appended if that name is already taken.
+std::string GosFrontline::LogService::freshFileName() const
+{
+    std::string stem = filePrefix + "_" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count() / 1000000);
+    std::string name = stem + ".log";
+    for (int i = 1; std::filesystem::exists(name); i++)
+    {
+        name = stem + "." + std::to_string(i) + ".log";
+    }
+    return name;
 }
 
-void GosFrontline::Logger::setEndFlag()
+/// @brief Close the current file, continue in a fresh one, then compress and prune old files.
+/// @note Writer thread only.
+void GosFrontline::LogService::rotate()
+{
+    std::string finished;
+    LogRotation rotation;
+    {
+        std::lock_guard<std::mutex> lock(m_file_mutex);
+        m_file.close();
+        finished = fileName;
+        fileName = freshFileName();
+        m_file.open(fileName, std::ios::out | std::ios::app);
+        rotation = m_rotation;
+    }
+    m_file_bytes = 0;
+    m_file_opened = std::chrono::steady_clock::now();
+
+    if (rotation.compress)
+    {
+        if (m_compression.valid())
+            m_compression.wait(); // One compression at a time is plenty
+        // Runs the system's gzip through the shell; without one the file stays uncompressed and a warning says why.
+        m_compression = std::async(std::launch::async, [this, finished]()
+                                   {
+                                       std::string command = "gzip -q -f \"" + finished + "\"";
+                                       int status = std::system(command.c_str());
+                                       if (status != 0)
+                                       {
+                                           log(channelId(""), "Could not gzip " + finished + " (status " + std::to_string(status) + "); it stays uncompressed.",
+                                               MessageType::WARNING);
+                                       } });
+    }
+    enforceRetention();
+}
+
+/// @brief Delete the oldest log files in the log directory until it fits max_directory_bytes.
+///        Files written to in the last minute are assumed to be in use and never deleted.
+void GosFrontline::LogService::enforceRetention()
+{
+    size_t cap;
+    std::string current, binary;
+    {
+        std::lock_guard<std::mutex> lock(m_file_mutex);
+        cap = m_rotation.max_directory_bytes;
+        current = fileName;
+        binary = binaryFileName;
+    }
+    if (cap == 0)
+        return;
+
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    std::vector<std::pair<fs::file_time_type, fs::path>> candidates;
+    size_t total = 0;
+    for (const auto &entry : fs::directory_iterator(pathName, ec))
+    {
+        if (not entry.is_regular_file(ec))
+            continue;
+        std::string name = entry.path().filename().string();
+        bool is_log = name.size() > 4 and (name.compare(name.size() - 4, 4, ".log") == 0 or
+                                           name.compare(name.size() - 3, 3, ".gz") == 0 or
+                                           name.compare(name.size() - 5, 5, ".glog") == 0);
+        if (not is_log)
+            continue;
+        total += entry.file_size(ec);
+        auto modified = entry.last_write_time(ec);
+        if (entry.path() == fs::path(current) or entry.path() == fs::path(binary) or
+            fs::file_time_type::clock::now() - modified < std::chrono::minutes(1))
+            continue;
+        candidates.emplace_back(modified, entry.path());
+    }
+    std::sort(candidates.begin(), candidates.end());
+    for (const auto &[modified, path] : candidates)
+    {
+        if (total <= cap)
+            break;
+        size_t size = fs::file_size(path, ec);
+        if (fs::remove(path, ec))
+            total -= std::min(total, size);
+    }
+}
+
+/// @brief A Logger on channel @p name of the same service; the channel is registered on first use.
+std::shared_ptr<GosFrontline::Logger> GosFrontline::LogService::channel(const std::string &name)
+{
+    return std::make_shared<Logger>(shared_from_this(), name);
+}
+
+GosFrontline::Logger::Logger(std::string fn)
+    : service(std::make_shared<LogService>(fn)), id(service->channelId(""))
+{
+}
+
+GosFrontline::Logger::Logger(std::string fn, std::string pn)
+    : service(std::make_shared<LogService>(fn, pn)), id(service->channelId(""))
+{
+}
+
+GosFrontline::Logger::Logger(std::shared_ptr<LogService> s, const std::string &channel)
+    : service(std::move(s)), id(service->channelId(channel))
+{
+}
+
+/// @brief A sibling channel writing to the same file as this one.
+std::shared_ptr<GosFrontline::Logger> GosFrontline::Logger::channel(const std::string &name) const
+{
+    return service->channel(name);
+}
+
+std::shared_ptr<GosFrontline::LogService> GosFrontline::Logger::getService() const
+{
+    return service;
+}
+
+void GosFrontline::Logger::log(const std::string &message, MessageType type)
+{
+    service->log(id, message, type);
+}
+
+bool GosFrontline::Logger::enabled(MessageType type) const
+{
+    return service->enabled(id, type);
+}
+
+/// @brief Switch one message type of this channel on or off; other channels are unaffected.
+void GosFrontline::Logger::setEnabled(MessageType type, bool on)
+{
+    service->setEnabled(id, type, on);
+}
+
+/// @note Rotation, the binary sink and flushing act on the whole shared service.
+void GosFrontline::Logger::setRotation(const LogRotation &rotation)
+{
+    service->setRotation(rotation);
+}
+
+bool GosFrontline::Logger::enableBinarySink(size_t capacity)
+{
+    return service->enableBinarySink(capacity);
+}
+
+std::string GosFrontline::Logger::getBinaryFileName() const
+{
+    return service->getBinaryFileName();
+}
+
+void GosFrontline::Logger::flush()
+{
+    service->flush();
+}
+
+/// @brief Kept for callers that used to drain the queue by hand; the writer thread does that now.
+void GosFrontline::Logger::run()
+{
+    flush();
+}
+
+std::string GosFrontline::Logger::getFileName() const
 {
-    endFlag = true;
+    return service->getFileName();
 }
 
-#endif // LOGGER_H
\ No newline at end of file
+#endif // LOGGER_H
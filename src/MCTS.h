@@ -1,28 +1,85 @@
 #ifndef MCTS_H
 #define MCTS_H
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <random>
+#include <string>
 #include <vector>
 #include <utility>
 #include "Gaming.h"
 
 namespace GosFrontline {
 
+// What the engine reports while it thinks, modelled on UCI "info" lines.
+struct SearchInfo {
+    int depth = 0, seldepth = 0;
+    uint64_t nodes = 0, nps = 0;
+    uint64_t tt_probes = 0, tt_hits = 0;        // Transposition table lookups and hits
+    std::chrono::microseconds time{0};           // Time used so far
+    std::vector<std::pair<int, int>> pv;         // Principal variation, best move first
+    bool final = false;                          // Last report of this search
+
+    double hashHitRate() const {
+        return tt_probes == 0 ? 0.0 : static_cast<double>(tt_hits) / tt_probes;
+    }
+
+    // "info depth 1 seldepth 1 nodes 225 nps 1000000 time 0 hashhits 0/0 pv 7,7 8,8"
+    std::string toString() const {
+        std::string line = "info depth " + std::to_string(depth) + " seldepth " + std::to_string(seldepth) +
+                           " nodes " + std::to_string(nodes) + " nps " + std::to_string(nps) +
+                           " time " + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(time).count()) +
+                           " hashhits " + std::to_string(tt_hits) + "/" + std::to_string(tt_probes) + " pv";
+        for (const auto &move : pv) {
+            line += " " + std::to_string(move.first) + "," + std::to_string(move.second);
+        }
+        return line;
+    }
+};
+
+using SearchInfoCallback = std::function<void(const SearchInfo &)>;
+
 class MCTS {
 private:
     std::random_device rd;
     std::mt19937 gen;
+    SearchInfoCallback on_info;
+    std::chrono::steady_clock::time_point search_start;
+
+    // Fill in time and nps, then hand the report to the callback, if any.
+    void report(SearchInfo &info) {
+        if (not on_info) {
+            return;
+        }
+        info.time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - search_start);
+        info.nps = info.time.count() > 0 ? info.nodes * 1000000 / info.time.count() : info.nodes * 1000000;
+        on_info(info);
+    }
 
 public:
     MCTS() : gen(rd()) {}
 
+    // Fixed seed, so a game can be replayed move for move.
+    explicit MCTS(unsigned seed) : gen(seed) {}
+
+    // Called with progress reports during a search and once with final = true when it ends.
+    // Runs on the searching thread, so it should be quick.
+    void setInfoCallback(SearchInfoCallback callback) {
+        on_info = std::move(callback);
+    }
+
     // Generate a random valid move for the given game state
     std::pair<int, int> getRandomMove(const Gaming& game) {
+        search_start = std::chrono::steady_clock::now();
         std::vector<std::pair<int, int>> validMoves;
+        SearchInfo info;
+        info.depth = info.seldepth = 1;
         
         // Collect all valid moves
         for(size_t i = 0; i < game.board.row_count(); i++) {
             for(size_t j = 0; j < game.board.col_count(); j++) {
+                info.nodes++;
                 if(game.isEmpty(i, j)) {
                     validMoves.push_back({i, j});
                 }
@@ -30,6 +87,8 @@ public:
         }
 
         if(validMoves.empty()) {
+            info.final = true;
+            report(info);
             return {-1, -1}; // No valid moves available
         }
 
@@ -37,6 +96,9 @@ public:
         std::uniform_int_distribution<> dis(0, validMoves.size() - 1);
         int randomIndex = dis(gen);
 
+        info.pv.push_back(validMoves[randomIndex]);
+        info.final = true;
+        report(info);
         return validMoves[randomIndex];
     }
 };
@@ -0,0 +1,412 @@
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <condition_variable>
+
+#ifdef __linux__
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace GosFrontline
+{
+  /// @brief Lets one consumer sleep until a producer signals new items.
+  ///        Sleeps on a futex on Linux and on a condition variable elsewhere. Producers only
+  ///        pay for a wake-up while the consumer is actually asleep.
+  class Parker
+  {
+  private:
+    std::atomic<uint32_t> epoch{0};
+    std::atomic<int> sleepers{0};
+#ifndef __linux__
+    std::mutex mutex;
+    std::condition_variable condition;
+#endif
+
+    /// @return false if @p timeout (negative = forever) ran out first.
+    bool sleep(uint32_t seen, std::chrono::nanoseconds timeout)
+    {
+#ifdef __linux__
+      if (timeout.count() < 0)
+      {
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&epoch), FUTEX_WAIT_PRIVATE, seen, nullptr, nullptr, 0);
+        return true;
+      }
+      timespec ts{static_cast<time_t>(timeout.count() / 1000000000), static_cast<long>(timeout.count() % 1000000000)};
+      syscall(SYS_futex, reinterpret_cast<uint32_t *>(&epoch), FUTEX_WAIT_PRIVATE, seen, &ts, nullptr, 0);
+      return epoch.load() != seen;
+#else
+      std::unique_lock<std::mutex> lock(mutex);
+      if (timeout.count() < 0)
+      {
+        condition.wait(lock, [this, seen]
+                       { return epoch.load() != seen; });
+        return true;
+      }
+      return condition.wait_for(lock, timeout, [this, seen]
+                                { return epoch.load() != seen; });
+#endif
+    }
+
+  public:
+    /// @brief Take a ticket before checking for work; pass it to wait() if there was none.
+    uint32_t ticket() const
+    {
+      return epoch.load(std::memory_order_acquire);
+    }
+
+    /// @brief Sleep until notify() has been called since @p seen was taken, or @p timeout passes.
+    /// @param timeout Negative waits forever.
+    /// @return false on timeout. Spurious true returns are possible; callers re-check their queue.
+    bool wait(uint32_t seen, std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1))
+    {
+      // Short spin first: under load the next item is usually only a few hundred cycles away.
+      for (int i = 0; i < 64; i++)
+      {
+        if (epoch.load(std::memory_order_acquire) != seen)
+          return true;
+        std::this_thread::yield();
+      }
+      sleepers.fetch_add(1); // seq_cst pairs with notify(): either we see the new epoch or it sees us
+      bool woken = (epoch.load() != seen) or sleep(seen, timeout);
+      sleepers.fetch_sub(1);
+      return woken;
+    }
+
+    void notify()
+    {
+      epoch.fetch_add(1);
+      if (sleepers.load() > 0)
+      {
+#ifdef __linux__
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&epoch), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+        std::lock_guard<std::mutex> lock(mutex);
+        condition.notify_one();
+#endif
+      }
+    }
+  };
+
+  /// @brief Unbounded lock-free multi-producer/single-consumer queue (intrusive Vyukov list).
+  ///        push() may be called from any thread; everything else from the consumer only.
+  template <typename T>
+  class MPSCQueue
+  {
+  private:
+    struct Node
+    {
+      std::atomic<Node *> next{nullptr};
+      std::optional<T> value;
+    };
+
+    std::atomic<Node *> head; // Last pushed node, shared by producers
+    Node *tail;               // Dummy node in front of the oldest item, consumer only
+    Parker parker;
+
+  public:
+    MPSCQueue() : head(new Node), tail(head.load()) {}
+
+    MPSCQueue(const MPSCQueue &) = delete;
+    MPSCQueue &operator=(const MPSCQueue &) = delete;
+
+    ~MPSCQueue()
+    {
+      while (tail != nullptr)
+      {
+        Node *next = tail->next.load(std::memory_order_relaxed);
+        delete tail;
+        tail = next;
+      }
+    }
+
+    template <typename... Args>
+    void emplace(Args &&...args)
+    {
+      Node *node = new Node;
+      node->value.emplace(std::forward<Args>(args)...);
+      Node *prev = head.exchange(node, std::memory_order_acq_rel);
+      prev->next.store(node, std::memory_order_release);
+      parker.notify();
+    }
+
+    void push(T &&item)
+    {
+      emplace(std::move(item));
+    }
+
+    void push(const T &item)
+    {
+      emplace(item);
+    }
+
+    std::optional<T> try_pop()
+    {
+      Node *next = tail->next.load(std::memory_order_acquire);
+      if (next == nullptr)
+      {
+        return std::nullopt;
+      }
+      std::optional<T> item(std::move(next->value));
+      next->value.reset(); // next becomes the new dummy
+      delete tail;
+      tail = next;
+      return item;
+    }
+
+    /// @brief Blocks until an item is available.
+    T pop()
+    {
+      while (true)
+      {
+        uint32_t seen = parker.ticket();
+        if (auto item = try_pop())
+        {
+          return std::move(*item);
+        }
+        parker.wait(seen);
+      }
+    }
+
+    /// @brief Blocks until an item is available or @p timeout passes.
+    /// @return The item, or std::nullopt on timeout.
+    template <typename Rep, typename Period>
+    std::optional<T> pop_for(const std::chrono::duration<Rep, Period> &timeout)
+    {
+      auto deadline = std::chrono::steady_clock::now() + timeout;
+      while (true)
+      {
+        uint32_t seen = parker.ticket();
+        if (auto item = try_pop())
+        {
+          return item;
+        }
+        auto left = deadline - std::chrono::steady_clock::now();
+        if (left <= left.zero() or not parker.wait(seen, std::chrono::duration_cast<std::chrono::nanoseconds>(left)))
+        {
+          return try_pop();
+        }
+      }
+    }
+
+    /// @brief Blocks until the queue is non-empty, then moves every queued item
+    ///        to the back of @p out.
+    /// @param out Any container supporting push_back.
+    template <typename Container>
+    void pop_all(Container &out)
+    {
+      out.push_back(pop());
+      while (auto item = try_pop())
+      {
+        out.push_back(std::move(*item));
+      }
+    }
+
+    /// @brief Like pop_all(), but gives up after @p timeout.
+    /// @return false if nothing arrived in time; @p out is then unchanged.
+    template <typename Container, typename Rep, typename Period>
+    bool pop_all_for(Container &out, const std::chrono::duration<Rep, Period> &timeout)
+    {
+      auto first = pop_for(timeout);
+      if (not first)
+      {
+        return false;
+      }
+      out.push_back(std::move(*first));
+      while (auto item = try_pop())
+      {
+        out.push_back(std::move(*item));
+      }
+      return true;
+    }
+
+    /// @note Consumer only. A push still being linked in may not be visible yet.
+    bool empty() const
+    {
+      return tail->next.load(std::memory_order_acquire) == nullptr;
+    }
+  };
+
+  /// @brief Bounded lock-free multi-producer/single-consumer ring buffer (Vyukov sequence cells).
+  ///        Never allocates after construction. Capacity is rounded up to a power of two.
+  template <typename T>
+  class BoundedMPSCQueue
+  {
+  private:
+    struct Cell
+    {
+      std::atomic<size_t> sequence;
+      std::optional<T> value;
+    };
+
+    std::vector<Cell> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueue_pos{0};
+    alignas(64) size_t dequeue_pos = 0; // Consumer only
+    Parker parker;
+
+    static size_t roundUp(size_t n)
+    {
+      size_t p = 2;
+      while (p < n)
+      {
+        p <<= 1;
+      }
+      return p;
+    }
+
+  public:
+    explicit BoundedMPSCQueue(size_t capacity) : cells(roundUp(capacity)), mask(roundUp(capacity) - 1)
+    {
+      for (size_t i = 0; i < cells.size(); i++)
+      {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    BoundedMPSCQueue(const BoundedMPSCQueue &) = delete;
+    BoundedMPSCQueue &operator=(const BoundedMPSCQueue &) = delete;
+
+    size_t capacity() const
+    {
+      return cells.size();
+    }
+
+    /// @brief Push without waiting.
+    /// @return false if the ring is full, in which case @p item is left untouched.
+    bool try_push(T &&item)
+    {
+      size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+      Cell *cell;
+      while (true)
+      {
+        cell = &cells[pos & mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+        if (diff == 0)
+        {
+          if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          {
+            break;
+          }
+        }
+        else if (diff < 0)
+        {
+          return false;
+        }
+        else
+        {
+          pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+      }
+      cell->value.emplace(std::move(item));
+      cell->sequence.store(pos + 1, std::memory_order_release);
+      parker.notify();
+      return true;
+    }
+
+    /// @brief Push, yielding while the ring is full.
+    void push(T &&item)
+    {
+      while (not try_push(std::move(item)))
+      {
+        std::this_thread::yield();
+      }
+    }
+
+    std::optional<T> try_pop()
+    {
+      Cell &cell = cells[dequeue_pos & mask];
+      if (cell.sequence.load(std::memory_order_acquire) != dequeue_pos + 1)
+      {
+        return std::nullopt;
+      }
+      std::optional<T> item(std::move(cell.value));
+      cell.value.reset();
+      cell.sequence.store(dequeue_pos + mask + 1, std::memory_order_release);
+      ++dequeue_pos;
+      return item;
+    }
+
+    /// @brief Blocks until an item is available.
+    T pop()
+    {
+      while (true)
+      {
+        uint32_t seen = parker.ticket();
+        if (auto item = try_pop())
+        {
+          return std::move(*item);
+        }
+        parker.wait(seen);
+      }
+    }
+
+    /// @brief Blocks until an item is available or @p timeout passes.
+    /// @return The item, or std::nullopt on timeout.
+    template <typename Rep, typename Period>
+    std::optional<T> pop_for(const std::chrono::duration<Rep, Period> &timeout)
+    {
+      auto deadline = std::chrono::steady_clock::now() + timeout;
+      while (true)
+      {
+        uint32_t seen = parker.ticket();
+        if (auto item = try_pop())
+        {
+          return item;
+        }
+        auto left = deadline - std::chrono::steady_clock::now();
+        if (left <= left.zero() or not parker.wait(seen, std::chrono::duration_cast<std::chrono::nanoseconds>(left)))
+        {
+          return try_pop();
+        }
+      }
+    }
+
+    template <typename Container>
+    void pop_all(Container &out)
+    {
+      out.push_back(pop());
+      while (auto item = try_pop())
+      {
+        out.push_back(std::move(*item));
+      }
+    }
+
+    template <typename Container, typename Rep, typename Period>
+    bool pop_all_for(Container &out, const std::chrono::duration<Rep, Period> &timeout)
+    {
+      auto first = pop_for(timeout);
+      if (not first)
+      {
+        return false;
+      }
+      out.push_back(std::move(*first));
+      while (auto item = try_pop())
+      {
+        out.push_back(std::move(*item));
+      }
+      return true;
+    }
+
+    /// @note Consumer only.
+    bool empty() const
+    {
+      return cells[dequeue_pos & mask].sequence.load(std::memory_order_acquire) != dequeue_pos + 1;
+    }
+  };
+
+} // namespace GosFrontline
+
+#endif // MPSCQUEUE_H
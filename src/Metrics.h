@@ -0,0 +1,102 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace GosFrontline
+{
+  /// @brief Percentiles of a LatencyHistogram at one point in time, in nanoseconds.
+  struct LatencySummary
+  {
+    uint64_t count = 0;
+    uint64_t mean_ns = 0;
+    uint64_t p50_ns = 0, p90_ns = 0, p99_ns = 0, p999_ns = 0;
+    uint64_t max_ns = 0;
+  };
+
+  /// @brief HDR-style latency histogram: log-linear buckets with 16 steps per power of two, so any
+  ///        reported percentile is within 6.25% of the true value from 1 ns up to about 18 minutes.
+  ///        record() is a couple of relaxed atomic adds and may be called from any thread, as may summary().
+  class LatencyHistogram
+  {
+  private:
+    static const int sub_bits = 4;                         // 16 sub-buckets per power of two
+    static const int max_exponent = 40;                    // 2^40 ns, longer values land in the top bucket
+    static const size_t bucket_count = (max_exponent - sub_bits + 2) << sub_bits;
+
+    std::array<std::atomic<uint64_t>, bucket_count> buckets{};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> max_seen{0};
+
+    static size_t bucketOf(uint64_t ns)
+    {
+      if (ns < (1u << sub_bits))
+        return static_cast<size_t>(ns);
+      int exponent = 63 - __builtin_clzll(ns);
+      if (exponent > max_exponent)
+        return bucket_count - 1;
+      size_t sub = static_cast<size_t>(ns >> (exponent - sub_bits)) & ((1u << sub_bits) - 1);
+      return (static_cast<size_t>(exponent - sub_bits + 1) << sub_bits) + sub;
+    }
+
+    /// @brief Largest value that falls into bucket @p index.
+    static uint64_t upperBound(size_t index)
+    {
+      if (index < (1u << sub_bits))
+        return index;
+      int exponent = static_cast<int>(index >> sub_bits) + sub_bits - 1;
+      uint64_t sub = index & ((1u << sub_bits) - 1);
+      return (((1ull << sub_bits) + sub + 1) << (exponent - sub_bits)) - 1;
+    }
+
+  public:
+    void record(std::chrono::nanoseconds elapsed)
+    {
+      uint64_t ns = elapsed.count() > 0 ? static_cast<uint64_t>(elapsed.count()) : 0;
+      buckets[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+      total_ns.fetch_add(ns, std::memory_order_relaxed);
+      uint64_t seen = max_seen.load(std::memory_order_relaxed);
+      while (ns > seen and not max_seen.compare_exchange_weak(seen, ns, std::memory_order_relaxed))
+      {
+      }
+    }
+
+    /// @note Concurrent record() calls may or may not be included; the result is never torn.
+    LatencySummary summary() const
+    {
+      std::array<uint64_t, bucket_count> counts;
+      LatencySummary result;
+      for (size_t i = 0; i < bucket_count; i++)
+      {
+        counts[i] = buckets[i].load(std::memory_order_relaxed);
+        result.count += counts[i];
+      }
+      if (result.count == 0)
+        return result;
+      result.max_ns = max_seen.load(std::memory_order_relaxed);
+      result.mean_ns = total_ns.load(std::memory_order_relaxed) / result.count;
+
+      const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+      uint64_t *targets[] = {&result.p50_ns, &result.p90_ns, &result.p99_ns, &result.p999_ns};
+      uint64_t seen = 0;
+      size_t next = 0;
+      for (size_t i = 0; i < bucket_count and next < 4; i++)
+      {
+        seen += counts[i];
+        while (next < 4 and seen >= static_cast<uint64_t>(quantiles[next] * result.count + 0.5))
+        {
+          *targets[next] = std::min(upperBound(i), result.max_ns);
+          next++;
+        }
+      }
+      return result;
+    }
+  };
+} // namespace GosFrontline
+
+#endif // METRICS_H
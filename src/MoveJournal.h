@@ -0,0 +1,378 @@
+#ifndef MOVEJOURNAL_H
+#define MOVEJOURNAL_H
+
+/// Append-only journal of the game in progress, so a crash loses at most the last few moves.
+/// A new or loaded game is written once in full; after that each move, undo or engine switch
+/// appends a record of a few bytes. Records are handed to one I/O thread, which writes whatever
+/// has piled up with a single write and fsync (group commit), so the backend never waits
+/// for the disk.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "SaveWriter.h"
+
+namespace GosFrontline
+{
+  /// @brief Little-endian layout: "GFLJ" | version u8 | 3 reserved bytes | records, each
+  ///        kind u8 | payload length varint | payload | CRC-32 of kind, length and payload (u32).
+  ///        Kinds: 'B' the game so far as a BinarySave (always first), 'M' a move (varint row * cols + col),
+  ///        'U' an undo (varint plies taken back), 'E' the engine side (u8).
+  ///        A record cut short by a crash fails its checksum and ends the journal there.
+  class MoveJournal
+  {
+  public:
+    static constexpr char magic[4] = {'G', 'F', 'L', 'J'};
+    static constexpr uint8_t version = 1;
+    static constexpr size_t header_size = 8;
+    static constexpr const char *extension = ".gflj";
+
+    MoveJournal() = default;
+    MoveJournal(const MoveJournal &) = delete;
+    MoveJournal &operator=(const MoveJournal &) = delete;
+
+    ~MoveJournal()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+      }
+      wake.notify_all();
+      if (worker.joinable())
+        worker.join();
+      closeFile();
+    }
+
+    /// @brief Journal to @p path from the next restart() on. Nothing is written until then, so a
+    ///        journal left by a crash stays readable until a game is started or loaded.
+    void open(const std::filesystem::path &path)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      target = path;
+      active = false;
+      if (not worker.joinable())
+        worker = std::thread([this]()
+                             { work(); });
+    }
+
+    /// @brief Start the journal over with @p game, replacing the file atomically.
+    void restart(const Gaming &game)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (target.empty())
+        return;
+      try
+      {
+        base.assign(magic, sizeof(magic));
+        base += static_cast<char>(version);
+        base.append(3, '\0');
+        append(base, 'B', BinarySave::encode(game));
+      }
+      catch (std::invalid_argument &e)
+      {
+        failure = e.what(); // Board too large for a BinarySave; this game goes unjournaled
+        active = false;
+        base.clear();
+        buffer.clear();
+        return;
+      }
+      cols = static_cast<int>(game.col_count());
+      active = true;
+      buffer.clear();
+      wake.notify_one();
+    }
+
+    void move(int row, int col)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      std::string payload;
+      BinarySave::putVarint(payload, static_cast<uint64_t>(row) * cols + col);
+      record('M', payload);
+    }
+
+    void undo(int plies)
+    {
+      if (plies <= 0)
+        return;
+      std::lock_guard<std::mutex> lock(mutex);
+      std::string payload;
+      BinarySave::putVarint(payload, static_cast<uint64_t>(plies));
+      record('U', payload);
+    }
+
+    void engine(PieceType side)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      record('E', std::string(1, static_cast<char>(static_cast<int>(side))));
+    }
+
+    /// @brief Block until every record so far is on disk.
+    void flush()
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      idle.wait(lock, [this]()
+                { return (base.empty() and buffer.empty() and not busy) or not worker.joinable(); });
+    }
+
+    /// @brief Records appended and disk commits made since open(); their ratio is the group commit size.
+    size_t records() const
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      return record_count;
+    }
+
+    size_t commits() const
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      return commit_count;
+    }
+
+    /// @brief The last write error, or empty. Journaling stops until the next restart() after one.
+    std::string error() const
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      return failure;
+    }
+
+    static bool detect(std::string_view data)
+    {
+      return data.size() >= sizeof(magic) and std::memcmp(data.data(), magic, sizeof(magic)) == 0;
+    }
+
+    /// @brief Rebuild the game a journal describes. A damaged or cut-off tail is dropped, so the
+    ///        result is the game as of the last record that reached the disk intact.
+    /// @throws std::runtime_error if @p data is not a journal or holds no intact game.
+    static Gaming decode(std::string_view data)
+    {
+      if (not detect(data) or data.size() < header_size)
+        throw std::runtime_error("Not a move journal.");
+      if (static_cast<uint8_t>(data[4]) != version)
+        throw std::runtime_error("Move journal version " + std::to_string(static_cast<uint8_t>(data[4])) + " is not supported.");
+
+      std::optional<Gaming> game;
+      PieceType engine_side = PieceType::None;
+      size_t at = header_size;
+      while (at < data.size())
+      {
+        char kind;
+        std::string_view payload;
+        if (not next(data, at, kind, payload))
+          break; // Torn tail
+        try
+        {
+          BinarySave::Reader in{payload, 0};
+          if (kind == 'B' and not game)
+          {
+            game = BinarySave::decode(payload);
+            engine_side = game->engineSide();
+            game->setEngineStatus(PieceType::None); // Replay both sides as plain moves
+          }
+          else if (not game)
+            break;
+          else if (kind == 'M')
+          {
+            uint64_t square = in.varint();
+            int game_cols = static_cast<int>(game->col_count());
+            if (not game->makeMove(static_cast<int>(square / game_cols), static_cast<int>(square % game_cols)))
+              break;
+          }
+          else if (kind == 'U')
+          {
+            for (uint64_t plies = in.varint(); plies > 0 and game->movesMade() > 0; plies--)
+              game->undo();
+          }
+          else if (kind == 'E')
+          {
+            int side = in.byte();
+            if (side > 2)
+              break;
+            engine_side = static_cast<PieceType>(side);
+          }
+        }
+        catch (std::runtime_error &)
+        {
+          break; // A record that checks out but does not apply; keep what was rebuilt before it
+        }
+      }
+      if (not game)
+        throw std::runtime_error("Move journal holds no game.");
+      game->setEngineStatus(engine_side);
+      return *game;
+    }
+
+  private:
+    mutable std::mutex mutex;
+    std::condition_variable wake, idle;
+    std::filesystem::path target;
+    std::string base;   // Header and 'B' record still to be written; replaces the file
+    std::string buffer; // Records still to be appended
+    int cols = 0;
+    bool active = false, busy = false, stopping = false;
+    size_t record_count = 0, commit_count = 0;
+    std::string failure;
+    std::thread worker;
+#ifdef GOSFRONTLINE_HAS_FSYNC
+    int fd = -1;
+#else
+    std::ofstream file;
+#endif
+
+    static void append(std::string &out, char kind, const std::string &payload)
+    {
+      size_t start = out.size();
+      out += kind;
+      BinarySave::putVarint(out, payload.size());
+      out += payload;
+      uint32_t crc = BinarySave::crc32(out.data() + start, out.size() - start);
+      for (int i = 0; i < 4; i++)
+        out += static_cast<char>((crc >> (8 * i)) & 0xFF);
+    }
+
+    /// @return false if the record at @p at is cut short or fails its checksum.
+    static bool next(std::string_view data, size_t &at, char &kind, std::string_view &payload)
+    {
+      try
+      {
+        BinarySave::Reader in{data, at};
+        kind = static_cast<char>(in.byte());
+        uint64_t length = in.varint();
+        if (length > data.size())
+          return false;
+        payload = in.bytes(static_cast<size_t>(length));
+        std::string_view crc = in.bytes(4);
+        uint32_t stored = 0;
+        for (int i = 0; i < 4; i++)
+          stored |= static_cast<uint32_t>(static_cast<uint8_t>(crc[i])) << (8 * i);
+        if (BinarySave::crc32(data.data() + at, in.at - 4 - at) != stored)
+          return false;
+        at = in.at;
+        return true;
+      }
+      catch (std::runtime_error &)
+      {
+        return false;
+      }
+    }
+
+    /// @note Called with mutex held.
+    void record(char kind, const std::string &payload)
+    {
+      if (not active)
+        return;
+      append(buffer, kind, payload);
+      record_count++;
+      wake.notify_one();
+    }
+
+    void work()
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (true)
+      {
+        wake.wait(lock, [this]()
+                  { return stopping or not base.empty() or not buffer.empty(); });
+        if (base.empty() and buffer.empty())
+          return; // Stopping with nothing left to write
+        std::string replace, records;
+        replace.swap(base);
+        records.swap(buffer);
+        std::filesystem::path path = target;
+        busy = true;
+        lock.unlock();
+
+        std::string error;
+        try
+        {
+          if (not replace.empty())
+          {
+            closeFile();
+            SaveWriter::writeAtomically(path, replace + records);
+            openFile(path);
+          }
+          else
+            appendFile(records);
+        }
+        catch (std::runtime_error &e)
+        {
+          error = e.what();
+          closeFile();
+        }
+
+        lock.lock();
+        busy = false;
+        commit_count++;
+        if (not error.empty())
+        {
+          failure = error;
+          active = false;
+          buffer.clear();
+        }
+        if (base.empty() and buffer.empty())
+          idle.notify_all();
+      }
+    }
+
+#ifdef GOSFRONTLINE_HAS_FSYNC
+    void openFile(const std::filesystem::path &path)
+    {
+      fd = ::open(path.c_str(), O_WRONLY | O_APPEND);
+      if (fd < 0)
+        throw std::runtime_error("Could not open journal " + path.string() + ".");
+    }
+
+    void appendFile(const std::string &records)
+    {
+      if (fd < 0)
+        throw std::runtime_error("Journal is not open.");
+      size_t written = 0;
+      while (written < records.size())
+      {
+        ssize_t n = ::write(fd, records.data() + written, records.size() - written);
+        if (n <= 0)
+          throw std::runtime_error("Could not append to journal.");
+        written += static_cast<size_t>(n);
+      }
+      if (::fsync(fd) != 0)
+        throw std::runtime_error("Could not sync journal.");
+    }
+
+    void closeFile()
+    {
+      if (fd >= 0)
+        ::close(fd);
+      fd = -1;
+    }
+#else
+    void openFile(const std::filesystem::path &path)
+    {
+      file.open(path, std::ios::out | std::ios::app | std::ios::binary);
+      if (not file.is_open())
+        throw std::runtime_error("Could not open journal " + path.string() + ".");
+    }
+
+    void appendFile(const std::string &records)
+    {
+      if (not file.write(records.data(), static_cast<std::streamsize>(records.size())) or not file.flush())
+        throw std::runtime_error("Could not append to journal.");
+    }
+
+    void closeFile()
+    {
+      if (file.is_open())
+        file.close();
+    }
+#endif
+  };
+} // namespace GosFrontline
+
+#endif // MOVEJOURNAL_H
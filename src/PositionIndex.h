@@ -0,0 +1,262 @@
+#ifndef POSITIONINDEX_H
+#define POSITIONINDEX_H
+
+/// Finds the stored games that reached a position. Every position of every game in an archive
+/// is hashed incrementally (one XOR per symmetry per move) and reduced to a canonical hash, the
+/// smallest over the board's symmetries, so mirrored and rotated positions match. The hashes are
+/// written sorted to a .gfpi file, which queries map and binary-search without loading it.
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "GameDatabase.h"
+
+namespace GosFrontline
+{
+  /// @brief A stored game that reached the queried position.
+  struct PositionHit
+  {
+    uint32_t game;    // Position in the archive
+    uint16_t ply;     // Moves played when the position arose
+    uint8_t symmetry; // PositionHasher transform that maps the game's board onto the canonical one
+  };
+
+  /// @brief Zobrist hashes of one position under all symmetries of its board, updated one move at a time.
+  ///        Square boards have 8 symmetries (rotations and reflections), other boards 4.
+  class PositionHasher
+  {
+  public:
+    static const int max_symmetries = 8;
+
+    PositionHasher(int rows, int cols)
+        : rows(rows), cols(cols), symmetries(rows == cols ? 8 : 4)
+    {
+      hashes.fill(0);
+    }
+
+    /// @brief Add a stone at @p row, @p col.
+    void add(int row, int col, PieceType side)
+    {
+      for (int s = 0; s < symmetries; s++)
+      {
+        auto [r, c] = transform(s, row, col);
+        hashes[s] ^= key(r, c, side);
+      }
+    }
+
+    /// @brief The canonical hash; @p symmetry is set to the transform that produced it.
+    uint64_t canonical(int &symmetry) const
+    {
+      symmetry = 0;
+      for (int s = 1; s < symmetries; s++)
+      {
+        if (hashes[s] < hashes[symmetry])
+          symmetry = s;
+      }
+      return hashes[symmetry];
+    }
+
+    uint64_t canonical() const
+    {
+      int symmetry;
+      return canonical(symmetry);
+    }
+
+    /// @brief Canonical hash of the current position of @p game.
+    static uint64_t hash(const Gaming &game)
+    {
+      PositionHasher hasher(static_cast<int>(game.row_count()), static_cast<int>(game.col_count()));
+      for (const auto &move : game.getSequence())
+        hasher.add(std::get<0>(move), std::get<1>(move), std::get<2>(move));
+      return hasher.canonical();
+    }
+
+    /// @brief Where symmetry @p s sends @p row, @p col. 0 is the identity, 1-3 reflect and rotate
+    ///        by 180 degrees, 4-7 (square boards only) transpose first.
+    std::pair<int, int> transform(int s, int row, int col) const
+    {
+      if (s >= 4)
+        std::swap(row, col);
+      if (s & 1)
+        col = cols - 1 - col;
+      if (s & 2)
+        row = rows - 1 - row;
+      return {row, col};
+    }
+
+  private:
+    int rows, cols, symmetries;
+    std::array<uint64_t, max_symmetries> hashes;
+
+    /// @brief Zobrist key of a stone, derived from its square, side and board size with splitmix64
+    ///        so any board size works without a table.
+    uint64_t key(int row, int col, PieceType side) const
+    {
+      uint64_t x = (static_cast<uint64_t>(rows) << 40) | (static_cast<uint64_t>(cols) << 32) |
+                   (static_cast<uint64_t>(row) << 16) | (static_cast<uint64_t>(col) << 2) | static_cast<uint64_t>(side);
+      x += 0x9E3779B97F4A7C15ull;
+      x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+      x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+      return x ^ (x >> 31);
+    }
+  };
+
+  /// @brief Sorted on-disk position index over one GameArchive. Little-endian layout:
+  ///        "GFPI" | version u8 | 3 reserved bytes | entry count u64 | archive game count u64 |
+  ///        archive size in bytes u64 | entries sorted by hash, 16 bytes each:
+  ///        hash u64 | game u32 | ply u16 | symmetry u8 | reserved u8.
+  ///        The archive counts let a reader notice that the archive has changed since the build.
+  /// @note Hashes are 64-bit, so unrelated positions collide with negligible but non-zero probability;
+  ///       callers that must be exact can replay the hit with GameDatabase::view.
+  class PositionIndex
+  {
+  public:
+    static constexpr char magic[4] = {'G', 'F', 'P', 'I'};
+    static constexpr uint8_t version = 1;
+    static constexpr size_t header_size = 32;
+    static constexpr size_t entry_size = 16;
+    static constexpr const char *extension = ".gfpi";
+
+    /// @throws std::runtime_error if @p path is not a position index.
+    explicit PositionIndex(const std::filesystem::path &path)
+        : file(path, false), data(file.bytes())
+    {
+      if (data.size() < header_size or std::memcmp(data.data(), magic, sizeof(magic)) != 0)
+        throw std::runtime_error("Not a position index.");
+      if (static_cast<uint8_t>(data[4]) != version)
+        throw std::runtime_error("Position index version " + std::to_string(static_cast<uint8_t>(data[4])) + " is not supported.");
+      count = read(8, 8);
+      archive_games = read(16, 8);
+      archive_bytes = read(24, 8);
+      if (count > (data.size() - header_size) / entry_size)
+        throw std::runtime_error("Position index is truncated.");
+    }
+
+    size_t size() const { return static_cast<size_t>(count); }
+
+    /// @brief Whether this index was built from @p db as it is now.
+    bool matches(const GameDatabase &db) const
+    {
+      return archive_games == db.size() and archive_bytes == db.bytes().size();
+    }
+
+    /// @brief Every stored game and ply with canonical hash @p hash, in game order.
+    std::vector<PositionHit> find(uint64_t hash) const
+    {
+      size_t low = 0, high = static_cast<size_t>(count);
+      while (low < high)
+      {
+        size_t mid = low + (high - low) / 2;
+        if (hashAt(mid) < hash)
+          low = mid + 1;
+        else
+          high = mid;
+      }
+      std::vector<PositionHit> hits;
+      for (size_t i = low; i < count and hashAt(i) == hash; i++)
+      {
+        size_t at = header_size + i * entry_size;
+        hits.push_back({static_cast<uint32_t>(read(at + 8, 4)), static_cast<uint16_t>(read(at + 12, 2)), static_cast<uint8_t>(data[at + 14])});
+      }
+      return hits;
+    }
+
+    /// @brief Stored games that reached the current position of @p game, in any orientation.
+    std::vector<PositionHit> find(const Gaming &game) const
+    {
+      return find(PositionHasher::hash(game));
+    }
+
+    /// @brief Index every position of every game in @p db into @p out, hashing on @p threads workers
+    ///        (all cores if 0). The empty board is not indexed.
+    /// @return The number of positions written.
+    /// @throws std::runtime_error if @p out cannot be written or a stored game is damaged.
+    static size_t build(const GameDatabase &db, const std::filesystem::path &out, unsigned threads = 0)
+    {
+      struct Entry
+      {
+        uint64_t hash;
+        uint32_t game;
+        uint16_t ply;
+        uint8_t symmetry;
+      };
+      if (db.size() > UINT32_MAX)
+        throw std::runtime_error("Archive has too many games for a position index.");
+
+      std::vector<Entry> entries;
+      std::mutex entries_mutex;
+      db.forEach([&](const GameView &view)
+                 {
+                   std::vector<Entry> local;
+                   local.reserve(view.moves.size());
+                   PositionHasher hasher(view.rows, view.cols);
+                   uint16_t ply = 0;
+                   for (const StoredMove &move : view.moves)
+                   {
+                     hasher.add(move.row, move.col, move.side);
+                     int symmetry;
+                     uint64_t hash = hasher.canonical(symmetry);
+                     local.push_back({hash, static_cast<uint32_t>(view.id), ++ply, static_cast<uint8_t>(symmetry)});
+                   }
+                   std::lock_guard<std::mutex> lock(entries_mutex);
+                   entries.insert(entries.end(), local.begin(), local.end()); },
+                 threads);
+      std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b)
+                { return a.hash != b.hash ? a.hash < b.hash : (a.game != b.game ? a.game < b.game : a.ply < b.ply); });
+
+      std::string buffer(magic, sizeof(magic));
+      buffer += static_cast<char>(version);
+      buffer.append(3, '\0');
+      write(buffer, entries.size(), 8);
+      write(buffer, db.size(), 8);
+      write(buffer, db.bytes().size(), 8);
+      buffer.reserve(header_size + entries.size() * entry_size);
+      for (const auto &e : entries)
+      {
+        write(buffer, e.hash, 8);
+        write(buffer, e.game, 4);
+        write(buffer, e.ply, 2);
+        buffer += static_cast<char>(e.symmetry);
+        buffer += '\0';
+      }
+      std::ofstream file(out, std::ios::out | std::ios::trunc | std::ios::binary);
+      if (not file.write(buffer.data(), static_cast<std::streamsize>(buffer.size())))
+        throw std::runtime_error("Could not write position index " + out.string() + ".");
+      return entries.size();
+    }
+
+  private:
+    MappedFile file;
+    std::string_view data;
+    uint64_t count = 0, archive_games = 0, archive_bytes = 0;
+
+    uint64_t read(size_t at, int bytes) const
+    {
+      uint64_t value = 0;
+      for (int i = 0; i < bytes; i++)
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(data[at + i])) << (8 * i);
+      return value;
+    }
+
+    uint64_t hashAt(size_t i) const
+    {
+      return read(header_size + i * entry_size, 8);
+    }
+
+    static void write(std::string &out, uint64_t value, int bytes)
+    {
+      for (int i = 0; i < bytes; i++)
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+  };
+} // namespace GosFrontline
+
+#endif // POSITIONINDEX_H
@@ -0,0 +1,128 @@
+#ifndef REPLAYVERIFIER_H
+#define REPLAYVERIFIER_H
+
+/// Plays stored move lists through the rules to find illegal games. Each move goes through
+/// Gaming::makeMove, so turn order and Sente's forbidden moves are judged exactly as in play,
+/// and only the last stone is checked for a win, so each ply costs a local scan around one square.
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "GameDatabase.h"
+
+namespace GosFrontline
+{
+  enum class ReplayError : uint8_t
+  {
+    None = 0,
+    OffBoard,  // Coordinates outside the board
+    Occupied,  // Square already taken
+    WrongSide, // Stone colour is not the side to move
+    Forbidden, // Sente played a forbidden move (double three, double four or overline)
+    AfterWin,  // A move after the game was already won
+    Damaged    // The stored record could not be read
+  };
+
+  /// @brief Outcome of replaying one game.
+  struct ReplayReport
+  {
+    ReplayError error = ReplayError::None;
+    int ply = 0; // 1-based ply of the first illegal move; 0 if every move was legal
+    int row = -1, col = -1;
+    int moves = 0;                      // Legal moves replayed before stopping
+    PieceType winner = PieceType::None; // Winner after the replayed moves
+    std::string detail;                 // Reason for ReplayError::Damaged
+
+    bool ok() const { return error == ReplayError::None; }
+
+    std::string describe() const
+    {
+      static const char *names[] = {"legal", "move off the board", "square already occupied", "wrong side to move",
+                                    "forbidden move for Sente", "move after the game was won", "damaged record"};
+      if (ok())
+        return "legal";
+      if (error == ReplayError::Damaged)
+        return std::string(names[static_cast<int>(error)]) + ": " + detail;
+      return std::string(names[static_cast<int>(error)]) + " at ply " + std::to_string(ply) + " (" +
+             std::to_string(row) + ", " + std::to_string(col) + ")";
+    }
+  };
+
+  class ReplayVerifier
+  {
+  public:
+    /// @brief Replay @p moves on an empty @p rows x @p cols board and stop at the first illegal one.
+    /// @param moves Any range of std::tuple<int, int, PieceType> (Gaming::getSequence) or StoredMove (MoveSpan).
+    template <class Moves>
+    static ReplayReport verify(int rows, int cols, const Moves &moves)
+    {
+      ReplayReport report;
+      Gaming game(rows, cols, PieceType::None);
+      for (const auto &move : moves)
+      {
+        auto [row, col, side] = unpack(move);
+        report.row = row;
+        report.col = col;
+        if (report.winner != PieceType::None)
+          return fail(report, ReplayError::AfterWin);
+        if (not game.isValidCoord(row, col))
+          return fail(report, ReplayError::OffBoard);
+        if (not game.isEmpty(row, col))
+          return fail(report, ReplayError::Occupied);
+        if (side != game.toMove())
+          return fail(report, ReplayError::WrongSide);
+        if (not game.makeMove(row, col))
+          return fail(report, ReplayError::Forbidden);
+        report.moves++;
+        report.winner = game.checkCurrentWin(row, col);
+      }
+      report.row = report.col = -1;
+      return report;
+    }
+
+    /// @brief Replay the move list of @p game.
+    static ReplayReport verify(const Gaming &game)
+    {
+      return verify(static_cast<int>(game.row_count()), static_cast<int>(game.col_count()), game.getSequence());
+    }
+
+    /// @brief Replay every game of @p db on @p threads workers (all cores if 0).
+    /// @return One report per game, indexed by game id. A damaged record gets ReplayError::Damaged
+    ///         and does not stop the run.
+    static std::vector<ReplayReport> verifyAll(const GameDatabase &db, unsigned threads = 0)
+    {
+      std::vector<ReplayReport> reports(db.size());
+      db.forEachId([&db, &reports](size_t i)
+                   {
+                     try
+                     {
+                       GameView view = db.view(i);
+                       reports[i] = verify(view.rows, view.cols, view.moves);
+                     }
+                     catch (std::runtime_error &e)
+                     {
+                       reports[i] = ReplayReport();
+                       reports[i].error = ReplayError::Damaged;
+                       reports[i].detail = e.what();
+                     } },
+                   threads);
+      return reports;
+    }
+
+  private:
+    static ReplayReport fail(ReplayReport &report, ReplayError error)
+    {
+      report.error = error;
+      report.ply = report.moves + 1;
+      return report;
+    }
+
+    static std::tuple<int, int, PieceType> unpack(const std::tuple<int, int, PieceType> &move) { return move; }
+    static std::tuple<int, int, PieceType> unpack(const StoredMove &move) { return {move.row, move.col, move.side}; }
+  };
+} // namespace GosFrontline
+
+#endif // REPLAYVERIFIER_H
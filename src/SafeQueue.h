@@ -1,59 +1,143 @@
 #ifndef SAFEQUEUE_H
 #define SAFEQUEUE_H
 
-#include <queue>
+#include <deque>
 #include <mutex>
+#include <chrono>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <condition_variable>
 
 namespace GosFrontline
 {
+  /// @brief What a bounded SafeQueue does with a push when it is full.
+  enum class OverflowPolicy
+  {
+    Block,      // Wait until the consumer makes room
+    DropOldest, // Evict the front item to make room
+    DropNewest, // Silently discard the incoming item
+    Reject      // Refuse the incoming item and leave it with the caller
+  };
+
   template <typename T>
   class SafeQueue
   {
 
   private:
-    std::queue<T> queue;
+    std::deque<T> queue;
     mutable std::mutex mutex;
     std::condition_variable condition;
+    std::condition_variable not_full;
+    size_t capacity = 0; // 0 means unbounded
+    OverflowPolicy policy = OverflowPolicy::Block;
+    size_t dropped_count = 0, rejected_count = 0;
+
+    bool full() const
+    {
+      return capacity != 0 and queue.size() >= capacity;
+    }
+
+    /// @brief Apply the overflow policy with the lock held.
+    /// @return Whether the incoming item may be queued.
+    bool makeRoom(std::unique_lock<std::mutex> &lock)
+    {
+      if (not full())
+        return true;
+      switch (policy)
+      {
+      case OverflowPolicy::Block:
+        not_full.wait(lock, [this]
+                      { return not full(); });
+        return true;
+      case OverflowPolicy::DropOldest:
+        queue.pop_front();
+        dropped_count++;
+        return true;
+      case OverflowPolicy::DropNewest:
+        dropped_count++;
+        return false;
+      case OverflowPolicy::Reject:
+      default:
+        rejected_count++;
+        return false;
+      }
+    }
+
+    void notifyPopped(size_t count)
+    {
+      if (capacity == 0 or count == 0)
+        return;
+      if (count == 1)
+        not_full.notify_one();
+      else
+        not_full.notify_all();
+    }
 
   public:
-    void push(const T &item)
+    /// @brief Unbounded queue.
+    SafeQueue() = default;
+
+    /// @brief Bounded queue holding at most @p max_items.
+    /// @param max_items Capacity; 0 means unbounded.
+    /// @param on_full What push does when the queue is full.
+    explicit SafeQueue(size_t max_items, OverflowPolicy on_full = OverflowPolicy::Block)
+        : capacity(max_items), policy(on_full) {}
+
+    /// @return false if the item was dropped or rejected by the overflow policy.
+    bool push(const T &item)
     {
-      std::lock_guard<std::mutex> lock(mutex);
-      queue.push(item);
+      std::unique_lock<std::mutex> lock(mutex);
+      if (not makeRoom(lock))
+        return false;
+      queue.push_back(item);
+      condition.notify_one();
+      return true;
+    }
+
+    /// @return false if the item was dropped or rejected by the overflow policy.
+    ///         A rejected item is not moved from.
+    bool push(T &&item)
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (not makeRoom(lock))
+        return false;
+      queue.push_back(std::move(item));
+      condition.notify_one();
+      return true;
+    }
+
+    /// @brief Construct an item in place at the back of the queue.
+    /// @return false if the item was dropped or rejected by the overflow policy.
+    template <typename... Args>
+    bool emplace(Args &&...args)
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (not makeRoom(lock))
+        return false;
+      queue.emplace_back(std::forward<Args>(args)...);
       condition.notify_one();
+      return true;
     }
 
-    /// @brief Pushing an item to the front of the queue
+    /// @brief Pushing an item to the front of the queue so it is popped next. O(1).
     /// @param item
     /// @warning DO NOT USE THIS FUNCTION UNLESS YOU KNOW WHAT YOU ARE DOING.
     ///          THIS IS NOT A DEQUE!
+    /// @note Priority items ignore the capacity limit.
     void _push_front(const T &item)
     {
       std::lock_guard<std::mutex> lock(mutex);
-      T dump;
-      std::queue<T> temp_dump;
-      while (not queue.empty())
-      {
-        dump = queue.front();
-        queue.pop();
-        temp_dump.push(dump);
-      }
-      queue.push(item);
-      while (not temp_dump.empty())
-      {
-        dump = temp_dump.front();
-        temp_dump.pop();
-        queue.push(dump);
-      }
+      queue.push_front(item);
       condition.notify_one();
     }
 
-    // void push(const T &&item)
-    // {
-    //   std::lock_guard<std::mutex> lock(mutex);
-    //   queue.push(std::forward<T>(item));
-    //   condition.notify_one();
-    // }
+    void _push_front(T &&item)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      queue.push_front(std::move(item));
+      condition.notify_one();
+    }
 
     T pop()
     {
@@ -61,17 +145,107 @@ namespace GosFrontline
       condition.wait(lock, [this]
                      { return !queue.empty(); });
       T item = std::move(queue.front());
-      queue.pop();
+      queue.pop_front();
+      lock.unlock();
+      notifyPopped(1);
+      return item;
+    }
+
+    /// @brief Pop without waiting.
+    /// @return The front item, or std::nullopt if the queue is empty.
+    std::optional<T> try_pop()
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (queue.empty())
+      {
+        return std::nullopt;
+      }
+      std::optional<T> item(std::move(queue.front()));
+      queue.pop_front();
+      notifyPopped(1);
       return item;
     }
 
+    /// @brief Pop, waiting at most @p timeout for an item to arrive.
+    /// @return The front item, or std::nullopt on timeout.
+    template <typename Rep, typename Period>
+    std::optional<T> pop_for(const std::chrono::duration<Rep, Period> &timeout)
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (not condition.wait_for(lock, timeout, [this]
+                                 { return !queue.empty(); }))
+      {
+        return std::nullopt;
+      }
+      std::optional<T> item(std::move(queue.front()));
+      queue.pop_front();
+      lock.unlock();
+      notifyPopped(1);
+      return item;
+    }
+
+    /// @brief Blocks until the queue is non-empty, then moves every queued item
+    ///        to the back of @p out under a single lock acquisition.
+    /// @param out Any container supporting push_back.
+    template <typename Container>
+    void pop_all(Container &out)
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait(lock, [this]
+                     { return !queue.empty(); });
+      size_t taken = queue.size();
+      for (auto &item : queue)
+      {
+        out.push_back(std::move(item));
+      }
+      queue.clear();
+      lock.unlock();
+      notifyPopped(taken);
+    }
+
+    /// @brief Moves every queued item to the back of @p out without waiting.
+    /// @return Number of items taken.
+    size_t try_pop_all(std::vector<T> &out)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      size_t taken = queue.size();
+      out.reserve(out.size() + taken);
+      for (auto &item : queue)
+      {
+        out.push_back(std::move(item));
+      }
+      queue.clear();
+      notifyPopped(taken);
+      return taken;
+    }
+
     bool empty() const
     {
       const std::lock_guard<std::mutex> lock(mutex);
       return queue.empty();
     }
+
+    size_t size() const
+    {
+      const std::lock_guard<std::mutex> lock(mutex);
+      return queue.size();
+    }
+
+    /// @brief Items discarded by DropOldest or DropNewest since construction.
+    size_t dropped() const
+    {
+      const std::lock_guard<std::mutex> lock(mutex);
+      return dropped_count;
+    }
+
+    /// @brief Pushes refused by Reject since construction.
+    size_t rejected() const
+    {
+      const std::lock_guard<std::mutex> lock(mutex);
+      return rejected_count;
+    }
   };
 
 } // namespace GosFrontline
 
-#endif // SAFEQUEUE_H
\ No newline at end of file
+#endif // SAFEQUEUE_H
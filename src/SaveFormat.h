@@ -0,0 +1,445 @@
+#ifndef SAVEFORMAT_H
+#define SAVEFORMAT_H
+
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "Gaming.h"
+
+namespace GosFrontline
+{
+  enum class SaveFormat
+  {
+    Text,  // .gfl: names, ASCII board and move list, human readable
+    Binary // .gflb: BinarySave, compact and loaded without parsing text
+  };
+
+  class GameArchive;
+  class GameDatabase;
+  class MoveJournal;
+
+  /// @brief A .gfl file that could not be parsed, with the 1-based line and column of the problem.
+  class SaveParseError : public std::runtime_error
+  {
+  public:
+    SaveParseError(size_t line, size_t column, const std::string &what)
+        : std::runtime_error("line " + std::to_string(line) + ", column " + std::to_string(column) + ": " + what),
+          line(line), column(column) {}
+
+    const size_t line, column;
+  };
+
+  /// @brief Compact versioned save format. Little-endian layout:
+  ///        "GFLB" | version u8 | flags u8 | rows u8 | cols u8 | engine u8 | reserved u8 |
+  ///        sente name, gote name (varint length + bytes) | saved-at seconds (varint) |
+  ///        move count (varint) | moves (varint of row * cols + col each, Sente first, alternating) |
+  ///        [board snapshot, 2 bits per square, if flags & has_board] | CRC-32 of everything before it (u32).
+  ///        A 15x15 game costs one or two bytes per move.
+  class BinarySave
+  {
+  public:
+    static constexpr char magic[4] = {'G', 'F', 'L', 'B'};
+    static constexpr uint8_t version = 1;
+    static constexpr uint8_t has_board = 1;
+    static constexpr const char *extension = ".gflb";
+
+    /// @brief Whether @p data starts like a binary save. Text saves start with "Sente:".
+    static bool detect(std::string_view data)
+    {
+      return data.size() >= sizeof(magic) and std::memcmp(data.data(), magic, sizeof(magic)) == 0;
+    }
+
+    /// @param with_board Also store the final board, so readers can show it without replaying moves.
+    static std::string encode(const Gaming &game, bool with_board = false)
+    {
+      const auto &moves = game.getSequence();
+      int rows = static_cast<int>(game.row_count()), cols = static_cast<int>(game.col_count());
+      if (rows > 255 or cols > 255)
+        throw std::invalid_argument("Board too large for the binary save format.");
+
+      std::string out(magic, sizeof(magic));
+      out += static_cast<char>(version);
+      out += static_cast<char>(with_board ? has_board : 0);
+      out += static_cast<char>(rows);
+      out += static_cast<char>(cols);
+      out += static_cast<char>(static_cast<int>(game.engineSide()));
+      out += '\0';
+      putString(out, game.getSenteName());
+      putString(out, game.getGoteName());
+      putVarint(out, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+                                               std::chrono::system_clock::now().time_since_epoch())
+                                               .count()));
+      putVarint(out, moves.size());
+      for (size_t i = 0; i < moves.size(); i++)
+      {
+        if (std::get<2>(moves[i]) != ((i % 2 == 0) ? PieceType::Sente : PieceType::Gote))
+          throw std::invalid_argument("Moves do not alternate from Sente; use the text format.");
+      }
+      for (const auto &move : moves)
+      {
+        putVarint(out, static_cast<uint64_t>(std::get<0>(move)) * cols + std::get<1>(move));
+      }
+      if (with_board)
+      {
+        const auto &board = game.getBoard();
+        std::string packed((static_cast<size_t>(rows) * cols + 3) / 4, '\0');
+        for (int r = 0; r < rows; r++)
+        {
+          for (int c = 0; c < cols; c++)
+          {
+            size_t square = static_cast<size_t>(r) * cols + c;
+            packed[square / 4] = static_cast<char>(packed[square / 4] | (static_cast<int>(board[r][c]) << (2 * (square % 4))));
+          }
+        }
+        out += packed;
+      }
+      uint32_t crc = crc32(out.data(), out.size());
+      for (int i = 0; i < 4; i++)
+        out += static_cast<char>((crc >> (8 * i)) & 0xFF);
+      return out;
+    }
+
+    /// @throws std::runtime_error if @p data is truncated, corrupt or from a newer version.
+    static Gaming decode(std::string_view data)
+    {
+      if (not detect(data) or data.size() < sizeof(magic) + 6 + 4)
+        throw std::runtime_error("Not a binary save file.");
+      uint32_t stored = 0;
+      for (int i = 0; i < 4; i++)
+        stored |= static_cast<uint32_t>(static_cast<uint8_t>(data[data.size() - 4 + i])) << (8 * i);
+      if (crc32(data.data(), data.size() - 4) != stored)
+        throw std::runtime_error("Binary save is corrupt: checksum mismatch.");
+
+      Reader in{data.substr(0, data.size() - 4), sizeof(magic)};
+      uint8_t file_version = in.byte();
+      if (file_version != version)
+        throw std::runtime_error("Binary save version " + std::to_string(file_version) + " is not supported.");
+      uint8_t flags = in.byte();
+      int rows = in.byte(), cols = in.byte();
+      int engine = in.byte();
+      in.byte(); // reserved
+      if (rows == 0 or cols == 0 or engine > 2)
+        throw std::runtime_error("Binary save has invalid board parameters.");
+      std::string sente = in.string(), gote = in.string();
+      in.varint(); // Saved-at time, informational
+      uint64_t count = in.varint();
+      if (count > static_cast<uint64_t>(rows) * cols)
+        throw std::runtime_error("Binary save has more moves than squares.");
+
+      std::vector<std::vector<PieceType>> board(rows, std::vector<PieceType>(cols, PieceType::None));
+      std::vector<std::tuple<int, int, PieceType>> sequence;
+      sequence.reserve(count);
+      for (uint64_t i = 0; i < count; i++)
+      {
+        uint64_t square = in.varint();
+        if (square >= static_cast<uint64_t>(rows) * cols)
+          throw std::runtime_error("Binary save has a move off the board.");
+        int r = static_cast<int>(square / cols), c = static_cast<int>(square % cols);
+        PieceType side = (i % 2 == 0) ? PieceType::Sente : PieceType::Gote;
+        if (board[r][c] != PieceType::None)
+          throw std::runtime_error("Binary save plays twice on " + std::to_string(r) + ", " + std::to_string(c) + ". Please check the file.");
+        board[r][c] = side;
+        sequence.emplace_back(r, c, side);
+      }
+      if (flags & has_board)
+      {
+        std::string_view packed = in.bytes((static_cast<size_t>(rows) * cols + 3) / 4);
+        for (int r = 0; r < rows; r++)
+        {
+          for (int c = 0; c < cols; c++)
+          {
+            size_t square = static_cast<size_t>(r) * cols + c;
+            int stone = (static_cast<uint8_t>(packed[square / 4]) >> (2 * (square % 4))) & 3;
+            if (stone != static_cast<int>(board[r][c]))
+              throw std::runtime_error("Binary save board snapshot does not match its moves.");
+          }
+        }
+      }
+      if (in.at != in.data.size())
+        throw std::runtime_error("Binary save has trailing data.");
+      return Gaming(rows, cols, board, sequence, sente, gote, static_cast<PieceType>(engine));
+    }
+
+    /// @brief CRC-32 (IEEE 802.3, as used by zlib and gzip).
+    static uint32_t crc32(const char *data, size_t size)
+    {
+      static const std::array<uint32_t, 256> table = []()
+      {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; i++)
+        {
+          uint32_t c = i;
+          for (int k = 0; k < 8; k++)
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+          t[i] = c;
+        }
+        return t;
+      }();
+      uint32_t crc = 0xFFFFFFFFu;
+      for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+      return crc ^ 0xFFFFFFFFu;
+    }
+
+  private:
+    friend class GameArchive;  // Shares the varint, string and CRC encoding for its index
+    friend class GameDatabase; // Reads records in place
+    friend class MoveJournal;  // Frames its records the same way
+
+    static void putVarint(std::string &out, uint64_t value)
+    {
+      while (value >= 0x80)
+      {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+      }
+      out += static_cast<char>(value);
+    }
+
+    static void putString(std::string &out, const std::string &text)
+    {
+      putVarint(out, text.size());
+      out += text;
+    }
+
+    /// @brief Bounds-checked cursor over the file contents.
+    struct Reader
+    {
+      std::string_view data;
+      size_t at;
+
+      uint8_t byte()
+      {
+        if (at >= data.size())
+          throw std::runtime_error("Binary save is truncated.");
+        return static_cast<uint8_t>(data[at++]);
+      }
+
+      uint64_t varint()
+      {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+          uint8_t b = byte();
+          value |= static_cast<uint64_t>(b & 0x7F) << shift;
+          if (not(b & 0x80))
+            return value;
+        }
+        throw std::runtime_error("Binary save has a malformed number.");
+      }
+
+      std::string_view bytes(size_t n)
+      {
+        if (data.size() - at < n)
+          throw std::runtime_error("Binary save is truncated.");
+        std::string_view view = data.substr(at, n);
+        at += n;
+        return view;
+      }
+
+      std::string string()
+      {
+        uint64_t n = varint();
+        return std::string(bytes(static_cast<size_t>(std::min<uint64_t>(n, data.size()))));
+      }
+    };
+  };
+
+  /// @brief The .gfl text format:
+  ///        "Sente: <name>", "Gote: <name>", "Time: <seconds>", "Engine Status: Sente|Gote|Disabled",
+  ///        "Board Parameters: <rows>*<cols>", then one line per board row ('@' Sente, 'O' Gote, ' ' empty),
+  ///        then one "<row> <col> Sente|Gote" line per move in the order played.
+  class TextSave
+  {
+  public:
+    static std::string encode(const Gaming &game)
+    {
+      std::string out;
+      out.reserve(160 + game.row_count() * (game.col_count() + 1) + game.movesMade() * 12);
+      PieceType engine = game.engineSide();
+      out += "Sente: " + game.getSenteName() + "\nGote: " + game.getGoteName() + "\n";
+      out += "Time: " + std::to_string(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count()) + "\n";
+      out += std::string("Engine Status: ") + ((engine == PieceType::None) ? "Disabled" : ((engine == PieceType::Sente) ? "Sente" : "Gote")) + "\n";
+      out += "Board Parameters: " + std::to_string(game.row_count()) + "*" + std::to_string(game.col_count()) + "\n";
+      for (const auto &row : game.getBoard())
+      {
+        for (PieceType item : row)
+          out += (item == PieceType::Sente) ? '@' : ((item == PieceType::Gote) ? 'O' : ' ');
+        out += '\n';
+      }
+      for (const auto &entry : game.getSequence())
+      {
+        out += std::to_string(std::get<0>(entry)) + ' ' + std::to_string(std::get<1>(entry)) + ' ' +
+               ((std::get<2>(entry) == PieceType::Sente) ? "Sente" : "Gote") + '\n';
+      }
+      return out;
+    }
+
+    /// @brief Single pass over @p data, one line at a time, without regex or copies of the text.
+    ///        Header lines may come in any order and unknown ones are skipped. Board rows may lose
+    ///        trailing spaces to an editor; CR line endings are accepted.
+    /// @throws SaveParseError locating the first problem.
+    static Gaming decode(std::string_view data)
+    {
+      Lines lines{data};
+      std::string sente, gote;
+      PieceType engine = PieceType::Gote;
+      int rows = -1, cols = -1;
+
+      // Header, up to and including "Board Parameters".
+      std::string_view line;
+      while (rows < 0)
+      {
+        if (not lines.next(line))
+          throw SaveParseError(lines.number + 1, 1, "missing \"Board Parameters\" line");
+        std::string_view value;
+        if (field(line, "Sente:", value))
+          sente = std::string(value);
+        else if (field(line, "Gote:", value))
+          gote = std::string(value);
+        else if (field(line, "Engine Status:", value))
+        {
+          if (value == "Sente")
+            engine = PieceType::Sente;
+          else if (value == "Gote")
+            engine = PieceType::Gote;
+          else if (value == "Disabled")
+            engine = PieceType::None;
+          else
+            throw SaveParseError(lines.number, column(line, value), "engine status must be Sente, Gote or Disabled");
+        }
+        else if (field(line, "Board Parameters:", value))
+        {
+          size_t star = value.find('*');
+          if (star == std::string_view::npos)
+            throw SaveParseError(lines.number, column(line, value), "expected <rows>*<cols>");
+          rows = number(lines.number, line, value.substr(0, star), 1, 255);
+          cols = number(lines.number, line, value.substr(star + 1), 1, 255);
+        }
+      }
+
+      // Board rows.
+      std::vector<std::vector<PieceType>> board(rows, std::vector<PieceType>(cols, PieceType::None));
+      int stone_count = 0;
+      for (int r = 0; r < rows; r++)
+      {
+        if (not lines.next(line))
+          throw SaveParseError(lines.number + 1, 1, "board ends after " + std::to_string(r) + " of " + std::to_string(rows) + " rows");
+        if (line.size() > static_cast<size_t>(cols))
+          throw SaveParseError(lines.number, cols + 1, "board row is longer than " + std::to_string(cols) + " squares");
+        for (size_t c = 0; c < line.size(); c++)
+        {
+          if (line[c] == '@')
+            board[r][c] = PieceType::Sente;
+          else if (line[c] == 'O')
+            board[r][c] = PieceType::Gote;
+          else if (line[c] != ' ')
+            throw SaveParseError(lines.number, c + 1, std::string("unexpected '") + line[c] + "' on the board");
+          stone_count += line[c] != ' ';
+        }
+      }
+
+      // Moves, one per line; blank lines are ignored.
+      std::vector<std::tuple<int, int, PieceType>> sequence;
+      sequence.reserve(stone_count);
+      while (lines.next(line))
+      {
+        if (line.find_first_not_of(" \t") == std::string_view::npos)
+          continue;
+        size_t first_end = line.find_first_of(" \t");
+        size_t second_begin = line.find_first_not_of(" \t", first_end);
+        size_t second_end = (second_begin == std::string_view::npos) ? std::string_view::npos : line.find_first_of(" \t", second_begin);
+        size_t side_begin = (second_end == std::string_view::npos) ? std::string_view::npos : line.find_first_not_of(" \t", second_end);
+        if (side_begin == std::string_view::npos)
+          throw SaveParseError(lines.number, 1, "expected \"<row> <col> Sente|Gote\"");
+        int r = number(lines.number, line, line.substr(0, first_end), 0, rows - 1);
+        int c = number(lines.number, line, line.substr(second_begin, second_end - second_begin), 0, cols - 1);
+        std::string_view side = trim(line.substr(side_begin));
+        PieceType type;
+        if (side == "Sente")
+          type = PieceType::Sente;
+        else if (side == "Gote")
+          type = PieceType::Gote;
+        else
+          throw SaveParseError(lines.number, side_begin + 1, "side must be Sente or Gote");
+        if (board[r][c] != type)
+          throw SaveParseError(lines.number, 1, "Invalid board: Moving sequence did not agree with board on stone type at " +
+                                                    std::to_string(r) + ", " + std::to_string(c) + ". Please check the file.");
+        sequence.emplace_back(r, c, type);
+      }
+      if (static_cast<int>(sequence.size()) != stone_count)
+        throw SaveParseError(lines.number, 1, "Invalid board: Moving sequence did not agree with board on stone count. Please check the file.");
+
+      return Gaming(rows, cols, board, sequence, sente, gote, engine);
+    }
+
+  private:
+    /// @brief Splits a buffer into lines without copying, tracking the line number.
+    struct Lines
+    {
+      std::string_view data;
+      size_t at = 0;
+      size_t number = 0;
+
+      bool next(std::string_view &line)
+      {
+        if (at >= data.size())
+          return false;
+        size_t end = data.find('\n', at);
+        if (end == std::string_view::npos)
+          end = data.size();
+        line = data.substr(at, end - at);
+        if (not line.empty() and line.back() == '\r')
+          line.remove_suffix(1);
+        at = end + 1;
+        number++;
+        return true;
+      }
+    };
+
+    static std::string_view trim(std::string_view text)
+    {
+      size_t begin = text.find_first_not_of(" \t");
+      if (begin == std::string_view::npos)
+        return text.substr(text.size()); // Empty, but still pointing into the line for column()
+      size_t end = text.find_last_not_of(" \t");
+      return text.substr(begin, end - begin + 1);
+    }
+
+    /// @brief If @p line starts with @p key, set @p value to the trimmed rest of it.
+    static bool field(std::string_view line, std::string_view key, std::string_view &value)
+    {
+      if (line.substr(0, key.size()) != key)
+        return false;
+      value = trim(line.substr(key.size()));
+      return true;
+    }
+
+    static size_t column(std::string_view line, std::string_view part)
+    {
+      return static_cast<size_t>(part.data() - line.data()) + 1;
+    }
+
+    static int number(size_t line_number, std::string_view line, std::string_view text, int low, int high)
+    {
+      text = trim(text);
+      int value = 0;
+      auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+      if (error != std::errc() or end != text.data() + text.size() or text.empty())
+        throw SaveParseError(line_number, column(line, text), "expected a number");
+      if (value < low or value > high)
+        throw SaveParseError(line_number, column(line, text), std::to_string(value) + " is outside " + std::to_string(low) + ".." + std::to_string(high));
+      return value;
+    }
+  };
+} // namespace GosFrontline
+
+#endif // SAVEFORMAT_H
@@ -0,0 +1,289 @@
+#ifndef SAVEWRITER_H
+#define SAVEWRITER_H
+
+/// Background writer for saved games. The backend hands over a snapshot and returns at once;
+/// one I/O thread encodes and writes it. Every file is replaced atomically (temporary file, fsync,
+/// rename), so a crash leaves either the old save or the new one, never half of it. Archives are
+/// appended to in place instead: GameArchive::Writer syncs the new records before the footer that
+/// indexes them, so a crash mid-append leaves the previous index in force.
+/// Saves to a path that is still waiting are coalesced: only the newest snapshot is written.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GameArchive.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GOSFRONTLINE_HAS_FSYNC 1
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace GosFrontline
+{
+  class SaveWriter
+  {
+  public:
+    /// @brief Called on the I/O thread once a save has been written or has failed.
+    /// @param error Empty on success.
+    /// @param elapsed From the first submit() for this write to its completion.
+    /// @param writing Time spent encoding and writing, excluding the wait in the queue.
+    using Callback = std::function<void(const std::string &error, std::chrono::steady_clock::duration elapsed,
+                                        std::chrono::steady_clock::duration writing)>;
+
+    SaveWriter() = default;
+    SaveWriter(const SaveWriter &) = delete;
+    SaveWriter &operator=(const SaveWriter &) = delete;
+
+    ~SaveWriter()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+      }
+      wake.notify_all();
+      if (worker.joinable())
+        worker.join();
+    }
+
+    /// @brief Queue @p game for writing to @p path; the format follows the extension (.gflb binary,
+    ///        .gfla archive append, anything else text). If a save to @p path is still waiting, its
+    ///        snapshot is replaced by this one and both callbacks fire when it is written. Archive
+    ///        appends are never merged, since each adds a game.
+    /// @param game Shared rather than copied; the backend passes its current snapshot.
+    void submit(const std::filesystem::path &path, std::shared_ptr<const Gaming> game, Callback done = nullptr)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (not worker.joinable())
+        worker = std::thread([this]()
+                             { work(); });
+      bool archive = path.extension() == GameArchive::extension;
+      auto waiting = queued.find(path);
+      if (waiting != queued.end() and not archive)
+      {
+        waiting->second.games.back() = std::move(game);
+        waiting->second.callbacks.push_back(std::move(done));
+        coalesced_count++;
+        return;
+      }
+      if (waiting == queued.end())
+      {
+        order.push_back(path);
+        waiting = queued.emplace(path, Job{{}, {}, std::chrono::steady_clock::now()}).first;
+      }
+      waiting->second.games.push_back(std::move(game));
+      waiting->second.callbacks.push_back(std::move(done));
+      wake.notify_one();
+    }
+
+    /// @brief Block until everything submitted so far has been written.
+    void flush()
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      idle.wait(lock, [this]()
+                { return order.empty() and not busy; });
+    }
+
+    /// @brief Saves absorbed into a later one to the same path since the writer was created.
+    size_t coalesced() const
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      return coalesced_count;
+    }
+
+    /// @brief Replace @p path with @p data: write a temporary file next to it, then replaceWith().
+    /// @throws std::runtime_error on any I/O failure; @p path is then untouched.
+    static void writeAtomically(const std::filesystem::path &path, const std::string &data)
+    {
+      std::filesystem::path temporary = path;
+      temporary += ".tmp";
+      {
+        std::ofstream out(temporary, std::ios::out | std::ios::trunc | std::ios::binary);
+        if (not out.write(data.data(), static_cast<std::streamsize>(data.size())) or not out.flush())
+        {
+          out.close();
+          std::error_code ec;
+          std::filesystem::remove(temporary, ec);
+          throw std::runtime_error("Could not write " + temporary.string() + ".");
+        }
+      }
+      replaceWith(temporary, path);
+    }
+
+    /// @brief Make the finished file @p temporary durable and move it over @p path: fsync it, rename it
+    ///        and fsync the directory, so after a crash @p path is either the old file or the new one.
+    /// @throws std::runtime_error on any I/O failure; @p temporary is removed and @p path is untouched.
+    static void replaceWith(const std::filesystem::path &temporary, const std::filesystem::path &path)
+    {
+#ifdef GOSFRONTLINE_HAS_FSYNC
+      int fd = ::open(temporary.c_str(), O_WRONLY);
+      bool synced = fd >= 0 and ::fsync(fd) == 0;
+      if (fd >= 0)
+        ::close(fd);
+      if (not synced or std::rename(temporary.c_str(), path.c_str()) != 0)
+      {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Could not replace " + path.string() + ".");
+      }
+      std::filesystem::path directory = path.parent_path().empty() ? std::filesystem::path(".") : path.parent_path();
+      int dir = ::open(directory.c_str(), O_RDONLY);
+      if (dir >= 0)
+      {
+        ::fsync(dir); // Makes the rename itself durable
+        ::close(dir);
+      }
+#else
+      std::error_code ec;
+      std::filesystem::rename(temporary, path, ec);
+      if (ec)
+      {
+        std::filesystem::remove(temporary, ec);
+        throw std::runtime_error("Could not replace " + path.string() + ".");
+      }
+#endif
+    }
+
+    /// @brief Rewrite the archive at @p path without the index segments later appends have merged away,
+    ///        then replace it atomically. Records are copied as they are, not decoded.
+    /// @throws std::runtime_error on any failure; @p path is then untouched.
+    static void compact(const std::filesystem::path &path)
+    {
+      std::filesystem::path temporary = path;
+      temporary += ".tmp";
+      try
+      {
+        std::filesystem::remove(temporary);
+        GameArchive archive(path);
+        GameArchive::Writer writer(temporary);
+        for (size_t i = 0; i < archive.size(); i++)
+          writer.add(archive.record(i), archive.entry(i));
+        writer.close();
+      }
+      catch (std::exception &e)
+      {
+        std::error_code ec;
+        std::filesystem::remove(temporary, ec);
+        throw std::runtime_error(e.what());
+      }
+      replaceWith(temporary, path);
+    }
+
+  private:
+    struct Job
+    {
+      std::vector<std::shared_ptr<const Gaming>> games; // One for file saves, one per append for archives
+      std::vector<Callback> callbacks;
+      std::chrono::steady_clock::time_point submitted;
+    };
+
+    mutable std::mutex mutex;
+    std::condition_variable wake, idle;
+    std::deque<std::filesystem::path> order; // Paths in first-submitted order
+    std::map<std::filesystem::path, Job> queued;
+    bool busy = false, stopping = false;
+    size_t coalesced_count = 0;
+    std::thread worker;
+
+    void work()
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (true)
+      {
+        wake.wait(lock, [this]()
+                  { return stopping or not order.empty(); });
+        if (order.empty())
+          return; // Stopping with nothing left to write
+        std::filesystem::path path = order.front();
+        order.pop_front();
+        Job job = std::move(queued.at(path));
+        queued.erase(path);
+        busy = true;
+        lock.unlock();
+
+        std::string error;
+        auto started = std::chrono::steady_clock::now();
+        try
+        {
+          write(path, job.games);
+        }
+        catch (std::exception &e)
+        {
+          error = e.what();
+        }
+        auto finished = std::chrono::steady_clock::now();
+        for (auto &done : job.callbacks)
+        {
+          if (done)
+            done(error, finished - job.submitted, finished - started);
+        }
+
+        lock.lock();
+        busy = false;
+        if (order.empty())
+          idle.notify_all();
+      }
+    }
+
+    static void write(const std::filesystem::path &path, const std::vector<std::shared_ptr<const Gaming>> &games)
+    {
+      if (path.extension() == GameArchive::extension)
+      {
+        // Appends go after the last footer and cost only the new records and index segment. A new
+        // archive is built aside and moved into place, so a crash never leaves a header with no index.
+        bool fresh = not std::filesystem::exists(path);
+        std::filesystem::path target = path;
+        if (fresh)
+        {
+          target += ".tmp";
+          std::filesystem::remove(target);
+        }
+        bool crowded = false;
+        try
+        {
+          GameArchive::Writer writer(target);
+          for (const auto &game : games)
+            writer.add(*game);
+          writer.close();
+          crowded = writer.garbage() > writer.bytes() / 2;
+        }
+        catch (std::exception &e)
+        {
+          std::error_code ec;
+          if (fresh)
+            std::filesystem::remove(target, ec);
+          throw std::runtime_error(e.what());
+        }
+        if (fresh)
+          replaceWith(target, path);
+        if (crowded)
+        {
+          try
+          {
+            compact(path);
+          }
+          catch (std::exception &)
+          {
+            // The games are saved either way; the next append tries again.
+          }
+        }
+        return;
+      }
+      const Gaming &game = *games.back();
+      writeAtomically(path, path.extension() == BinarySave::extension ? BinarySave::encode(game) : TextSave::encode(game));
+    }
+  };
+} // namespace GosFrontline
+
+#endif // SAVEWRITER_H
@@ -3,6 +3,8 @@
 
 #include <regex>
 #include <cctype>
+#include <fstream>
+#include <string>
 
 namespace GosFrontline
 {
@@ -1,6 +1,7 @@
 #ifndef BACKEND_H
 #define BACKEND_H
 
+#include <algorithm>
 #include <thread>
 #include <memory>
 #include <mutex>
@@ -8,11 +9,23 @@
 #include <condition_variable>
 #include <chrono>
 #include <filesystem>
+#include <fstream>
+#include <deque>
+#include <future>
+#include <optional>
+#include <variant>
 
 #include "Gaming.h"
 #include "Utilities.h"
+#include "MPSCQueue.h"
 #include "SafeQueue.h"
 #include "Logger.h"
+#include "Metrics.h"
+#include "SaveFormat.h"
+#include "GameArchive.h"
+#include "ReplayVerifier.h"
+#include "SaveWriter.h"
+#include "MoveJournal.h"
 #include "MCTS.h"
 
 namespace GosFrontline
@@ -27,53 +40,192 @@ namespace GosFrontline
     UnknownError
   };
 
+  /// @brief Immutable copy of the game between two state changes. The backend builds one the first time
+  ///        it is read after a change and hands the same one to every reader until the next change,
+  ///        so repeated reads cost a reference count instead of a copy of the board.
+  struct GameSnapshot
+  {
+    Gaming game;
+    uint64_t version;  // Counts the commands that may have changed the game; equal versions mean equal games
+    uint64_t sequence; // Last GameDelta this snapshot includes
+
+    const std::vector<std::vector<PieceType>> &board() const { return game.getBoard(); }
+    int step() const { return game.movesMade(); }
+  };
+  using SnapshotPtr = std::shared_ptr<const GameSnapshot>;
+
+  /// @brief One change to the game, as streamed to a DeltaSubscription.
+  struct GameDelta
+  {
+    enum class Kind : uint8_t
+    {
+      Placed, // A stone was put on row, col
+      Undone, // The stone on row, col was taken back
+      Reset,  // The board was cleared to rows x cols; a loaded game follows as Placed deltas
+      Result  // side has won with the last Placed stone
+    };
+    Kind kind;
+    uint64_t sequence = 0; // 1 for the first delta, then consecutive across all subscribers
+    int row = -1, col = -1;
+    PieceType side = PieceType::None;
+    int rows = 0, cols = 0;
+  };
+
+  /// @brief A front end's feed of GameDelta from Backend::subscribe(). To stay in sync, a client applies
+  ///        deltas in sequence order. It resyncs from Backend::getGame() when it first subscribes and
+  ///        whenever a sequence number is skipped, then skips deltas up to GameSnapshot::sequence.
+  class DeltaSubscription
+  {
+  public:
+    explicit DeltaSubscription(size_t backlog) : deltas(backlog, OverflowPolicy::DropOldest) {}
+
+    /// @brief The oldest delta not yet taken, without waiting.
+    std::optional<GameDelta> next() { return deltas.try_pop(); }
+
+    template <typename Rep, typename Period>
+    std::optional<GameDelta> next(const std::chrono::duration<Rep, Period> &timeout) { return deltas.pop_for(timeout); }
+
+    /// @brief Deltas dropped because the backlog was full. Their gap in the sequence calls for a resync.
+    size_t dropped() const { return deltas.dropped(); }
+
+  private:
+    friend class Backend;
+    SafeQueue<GameDelta> deltas;
+  };
+
+  /// @brief What Backend::getStats() reports. Latencies run from the call that queued a command
+  ///        (frontendMove, getBoard, ...) to the moment its handler finished and the reply was set.
+  struct BackendStats
+  {
+    struct Action
+    {
+      std::string name;
+      LatencySummary total;   // Enqueue to reply
+      LatencySummary service; // Time spent in the handler alone; total - service is queueing
+    };
+    std::vector<Action> actions; // Only actions seen at least once
+    size_t queue_depth = 0;      // Commands queued but not yet handled
+    size_t max_queue_depth = 0;
+    uint64_t batches = 0;        // Times the run loop drained the queue
+    size_t max_batch = 0;
+    uint64_t snapshot_hits = 0, snapshot_misses = 0; // GetBoard/GetGame served from / rebuilding the cache
+    size_t journal_records = 0, journal_commits = 0;  // Autosave journal; records per commit is the group commit size
+    std::chrono::steady_clock::duration uptime{};
+  };
+
   class Backend
   {
   private:
     using BoardType = std::vector<std::vector<GosFrontline::PieceType>>;
-    using BoardAndStep = std::pair<BoardType, int>;
     using MoveAndStep = std::pair<GosFrontline::MoveReply, int>;
     using BoardAndSequence = std::pair<BoardType, std::vector<std::tuple<int, int, GosFrontline::PieceType>>>;
 
     template <typename T>
     using PromiseWrapper = std::shared_ptr<std::promise<T>>;
 
-    enum class Action
+    // Commands accepted by the backend. Each command carries its own arguments and
+    // the promise it must fulfil, so the run loop never has to match them up later.
+    struct MoveHumanAction
+    {
+      int row, col;
+      PromiseWrapper<MoveAndStep> reply;
+    };
+    struct MoveEngineAction
     {
-      MoveHuman,
-      MoveEngine,
-      Undo,
-      Quit,
-      GetBoard,
-      GetGame,
-      GetEngineStatus,
-      SetEngineStatus,
-      SetEngineStatusOff,
-      Save,
-      NewGame,
-      LoadGame,
-      SetSenteName,
-      SetGoteName,
-      SetViolationPolicy,
-      CallEngine,
-      ReverseSides
+      int row, col;
+      PromiseWrapper<void> reply;
+    };
+    struct UndoAction
+    {
+      PromiseWrapper<bool> reply;
+    };
+    struct QuitAction
+    {
+    };
+    struct GetBoardAction
+    {
+      PromiseWrapper<SnapshotPtr> reply;
+    };
+    struct GetGameAction
+    {
+      PromiseWrapper<SnapshotPtr> reply;
+    };
+    struct SetEngineStatusOffAction
+    {
+    };
+    struct SaveAction
+    {
+      std::filesystem::path path;
+      PromiseWrapper<void> reply;
+    };
+    struct NewGameAction
+    {
+      int rows, cols;
+    };
+    struct LoadGameAction
+    {
+      std::filesystem::path path;
+      PromiseWrapper<bool> reply;
+      std::optional<size_t> entry; // Game to load from a GameArchive
+    };
+    /// @note reply may be empty when the backend schedules the engine by itself.
+    struct CallEngineAction
+    {
+      PromiseWrapper<bool> reply;
+    };
+    struct ReverseSidesAction
+    {
+    };
+
+    using Command = std::variant<MoveHumanAction, MoveEngineAction, UndoAction, QuitAction, GetBoardAction,
+                                 GetGameAction, SetEngineStatusOffAction, SaveAction, NewGameAction,
+                                 LoadGameAction, CallEngineAction, ReverseSidesAction>;
+    static constexpr size_t command_kinds = std::variant_size_v<Command>;
+    static const std::array<const char *, command_kinds + 1> action_names; // Indexed like Command, plus SaveWrite
+
+    struct QueuedCommand
+    {
+      Command command;
+      std::chrono::steady_clock::time_point enqueued;
+      bool internal = false; // Scheduled by the backend itself, so never counted in queue_depth
+    };
+
+    // Latency per Command alternative; the extra slot times the background save writer.
+    struct Metrics
+    {
+      std::array<LatencyHistogram, command_kinds + 1> total, service;
+      std::atomic<size_t> queue_depth{0}, max_queue_depth{0}, max_batch{0};
+      std::atomic<uint64_t> batches{0}, snapshot_hits{0}, snapshot_misses{0};
+      std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
     };
 
     Gaming game;
     std::shared_ptr<Logger> logger;
+    std::shared_ptr<Logger> engine_log; // Channels of the same log service as logger
+    std::shared_ptr<Logger> io_log;
+    std::shared_ptr<Logger> metrics_log;
     mutable std::recursive_mutex game_mutex;
     std::condition_variable game_cv;
-    SafeQueue<Action> todo;                                                                      // Inwards Queue
-    SafeQueue<std::tuple<int, int, std::shared_ptr<std::promise<MoveAndStep>>>> todo_move_human; // Inwards Queue
-    SafeQueue<std::tuple<int, int, PromiseWrapper<void>>> todo_move_engine;                      // Inwards Queue
-    SafeQueue<PromiseWrapper<BoardAndStep>> boards;                                              // Outwards Queue
-    SafeQueue<std::pair<MoveReply, int>> move_replies;                                           // Deprecated Queue
-    SafeQueue<std::pair<Action, PromiseWrapper<bool>>> todo_actions;
-    SafeQueue<std::pair<std::filesystem::path, PromiseWrapper<void>>> todo_save;
-    SafeQueue<std::pair<std::filesystem::path, PromiseWrapper<bool>>> todo_load;
-    SafeQueue<PromiseWrapper<Gaming>> game_copies;
-
-    std::stringstream log_stream;
+    MPSCQueue<QueuedCommand> todo;     // Inwards Queue, processed strictly in order
+    std::deque<QueuedCommand> pending; // Batch drained from todo, owned by the backend thread
+
+    Metrics metrics;
+    static const size_t search_info_backlog = 256;
+    SafeQueue<SearchInfo> search_info{search_info_backlog, OverflowPolicy::DropOldest}; // Engine reports for the front end
+    std::atomic<std::chrono::steady_clock::rep> stats_interval{std::chrono::steady_clock::duration(std::chrono::seconds(60)).count()};
+    std::chrono::steady_clock::time_point last_stats_dump = std::chrono::steady_clock::now(); // Backend thread only
+
+    // Shared by every GetBoard/GetGame/Save served until the game changes again. Backend thread only.
+    SnapshotPtr snapshot;
+    uint64_t version = 0;
+
+    uint64_t delta_sequence = 0; // Backend thread only
+    std::mutex subscribers_mutex;
+    std::vector<std::weak_ptr<DeltaSubscription>> subscribers;
+
+    // Declared after the loggers, so pending writes finish before those go away.
+    SaveWriter saver;
+    MoveJournal journal; // Autosave of the game in progress, see setJournal()
 
     Backend() {};
 
@@ -81,11 +233,32 @@ namespace GosFrontline
     std::pair<GosFrontline::MoveReply, int> registerHumanMove(int, int);
     std::pair<GosFrontline::MoveReply, int> registerEngineMove(int, int);
 
-    void boardSaver(std::filesystem::path);
-    Gaming boardLoader(std::filesystem::path);
+    Gaming boardLoader(std::filesystem::path, std::optional<size_t> entry = std::nullopt);
+
+    const SnapshotPtr &currentSnapshot();
+    void publish(GameDelta);
+    void movePlaced(int row, int col);
+    void movesUndone(const std::vector<std::tuple<int, int, PieceType>> &removed);
+    void gameReset();
+    void enqueue(Command &&);
+    void scheduleNext(Command);
+    void dumpStats();
+
+    // Command handlers. Each returns false when the backend should stop running.
+    bool handle(MoveHumanAction &);
+    bool handle(MoveEngineAction &);
+    bool handle(UndoAction &);
+    bool handle(QuitAction &);
+    bool handle(GetBoardAction &);
+    bool handle(GetGameAction &);
+    bool handle(SetEngineStatusOffAction &);
+    bool handle(SaveAction &);
+    bool handle(NewGameAction &);
+    bool handle(LoadGameAction &);
+    bool handle(CallEngineAction &);
+    bool handle(ReverseSidesAction &);
 
     static const int default_size = 15;
-    int rows = default_size, cols = default_size;
 
   public:
     static Backend &getBackend();
@@ -103,25 +276,42 @@ namespace GosFrontline
     std::future<void> save(std::string);
     void reverseSides();
     void newGame(int row, int col);
-    std::future<bool> loadGame(std::string);
+    std::future<bool> loadGame(std::string, std::optional<size_t> entry = std::nullopt);
     void quit();
     PieceType tomove();
 
     // Getters
-    std::future<BoardAndStep> getBoard();
+    std::future<SnapshotPtr> getBoard();
     // std::pair<MoveReply, int> getMoveReply();
-    std::future<Gaming> getGame();
+    std::future<SnapshotPtr> getGame();
     bool boardUpdated();
     std::future<void> checkWin();
 
     // Logging
     void setLogger(std::shared_ptr<Logger>);
 
+    // Autosave
+    void setJournal(std::filesystem::path);
+
+    // Engine reports
+    std::optional<SearchInfo> nextSearchInfo();
+
+    // Board updates
+    std::shared_ptr<DeltaSubscription> subscribe(size_t backlog = 1024);
+
+    // Metrics
+    BackendStats getStats() const;
+    void setStatsInterval(std::chrono::seconds);
+
     // Running
     int run();
   };
 } // namespace GosFrontline
 
+const std::array<const char *, GosFrontline::Backend::command_kinds + 1> GosFrontline::Backend::action_names = {
+    "MoveHuman", "MoveEngine", "Undo", "Quit", "GetBoard", "GetGame", "SetEngineStatusOff",
+    "Save", "NewGame", "LoadGame", "CallEngine", "ReverseSides", "SaveWrite"};
+
 GosFrontline::Backend &GosFrontline::Backend::getBackend()
 {
   static Backend instance;
@@ -132,8 +322,7 @@ std::future<GosFrontline::Backend::MoveAndStep> GosFrontline::Backend::frontendM
 {
   auto ready = std::make_shared<std::promise<GosFrontline::Backend::MoveAndStep>>();
   std::future<GosFrontline::Backend::MoveAndStep> ready_future = ready->get_future();
-  todo_move_human.push(std::move(std::make_tuple(row, col, ready)));
-  todo.push(Action::MoveHuman);
+  enqueue(MoveHumanAction{row, col, ready});
   return ready_future;
 }
 
@@ -141,15 +330,13 @@ std::future<bool> GosFrontline::Backend::frontendUndo()
 {
   PromiseWrapper<bool> ready = std::make_shared<std::promise<bool>>();
   std::future<bool> ready_future = ready->get_future();
-  todo_actions.push(std::make_pair(Action::Undo, ready));
-  todo.push(Action::Undo);
+  enqueue(UndoAction{ready});
   return ready_future;
 }
 
 void GosFrontline::Backend::engineMove(int row, int col, PromiseWrapper<void> status)
 {
-  todo_move_engine.push(std::make_tuple(row, col, status));
-  todo.push(Action::MoveEngine);
+  enqueue(MoveEngineAction{row, col, status});
 }
 
 GosFrontline::PieceType GosFrontline::Backend::tomove()
@@ -163,29 +350,27 @@ GosFrontline::PieceType GosFrontline::Backend::tomove()
 //   boards.push(std::move(std::make_pair(game.getBoard(), game.movesMade())));
 // }
 
-std::future<std::pair<std::vector<std::vector<GosFrontline::PieceType>>, int>> GosFrontline::Backend::getBoard()
+std::future<GosFrontline::SnapshotPtr> GosFrontline::Backend::getBoard()
 {
-  auto ready = std::make_shared<std::promise<std::pair<std::vector<std::vector<GosFrontline::PieceType>>, int>>>();
-  std::future<std::pair<std::vector<std::vector<GosFrontline::PieceType>>, int>> ready_future = ready->get_future();
-  boards.push(ready);
-  todo.push(Action::GetBoard);
-  logger->log("Logged in Action::GetBoard.");
+  auto ready = std::make_shared<std::promise<SnapshotPtr>>();
+  std::future<SnapshotPtr> ready_future = ready->get_future();
+  enqueue(GetBoardAction{ready});
+  logger->logf(MessageType::INFO, "Logged in Action::GetBoard.");
   return ready_future;
 }
 
-std::future<GosFrontline::Gaming> GosFrontline::Backend::getGame()
+std::future<GosFrontline::SnapshotPtr> GosFrontline::Backend::getGame()
 {
-  auto ready = std::make_shared<std::promise<GosFrontline::Gaming>>();
-  std::future<GosFrontline::Gaming> ready_future = ready->get_future();
-  GosFrontline::Backend::game_copies.push(ready);
-  GosFrontline::Backend::todo.push(Action::GetGame);
-  logger->log("Logged in Action::GetGame.");
+  auto ready = std::make_shared<std::promise<SnapshotPtr>>();
+  std::future<SnapshotPtr> ready_future = ready->get_future();
+  enqueue(GetGameAction{ready});
+  logger->logf(MessageType::INFO, "Logged in Action::GetGame.");
   return ready_future;
 }
 
-bool GosFrontline::Backend::boardUpdated() // Deprecated!
+bool GosFrontline::Backend::boardUpdated() // Deprecated! Replies go straight into futures, nothing is left pending here.
 {
-  return !boards.empty();
+  return false;
 }
 
 std::pair<GosFrontline::MoveReply, int> GosFrontline::Backend::registerHumanMove(int row, int col)
@@ -211,6 +396,7 @@ std::pair<GosFrontline::MoveReply, int> GosFrontline::Backend::registerHumanMove
   {
     return std::make_pair(MoveReply::UnknownError, game.movesMade() + 1);
   }
+  movePlaced(row, col);
   // Game move should already have been made. Check if it is a winning move.
   if (game.checkCurrentWin(row, col) == Opposite(game.toMove()))
   {
@@ -244,6 +430,7 @@ std::pair<GosFrontline::MoveReply, int> GosFrontline::Backend::registerEngineMov
   {
     return std::make_pair(MoveReply::UnknownError, game.movesMade() + 1);
   }
+  movePlaced(row, col);
 
   // enqueueBoard();
   return std::make_pair(MoveReply::Success, game.movesMade()); // Move was made, movesMade was implicitly updated
@@ -251,19 +438,17 @@ std::pair<GosFrontline::MoveReply, int> GosFrontline::Backend::registerEngineMov
 
 void GosFrontline::Backend::newGame(int r = default_size, int c = default_size)
 {
-  rows = r;
-  cols = c;
-  todo.push(Action::NewGame);
-  logger->log("Logged in Action::NewGame.");
+  enqueue(NewGameAction{r, c});
+  logger->logf(MessageType::INFO, "Logged in Action::NewGame.");
 }
 
-std::future<bool> GosFrontline::Backend::loadGame(std::string filename)
+/// @param entry For a GameArchive, the game to load; the last one if empty.
+std::future<bool> GosFrontline::Backend::loadGame(std::string filename, std::optional<size_t> entry)
 {
   auto ready = std::make_shared<std::promise<bool>>();
   auto ready_future = ready->get_future();
-  todo_load.push(std::make_pair(filename, ready));
-  todo.push(Action::LoadGame);
-  logger->log("Logged in Action::Load.");
+  enqueue(LoadGameAction{std::filesystem::path(filename), ready, entry});
+  logger->logf(MessageType::INFO, "Logged in Action::Load.");
   return ready_future;
 }
 
@@ -271,9 +456,8 @@ std::future<bool> GosFrontline::Backend::callEngine()
 {
   auto ready = std::make_shared<std::promise<bool>>();
   auto ready_future = ready->get_future();
-  todo_actions.push(std::make_pair(Action::CallEngine, ready));
-  todo.push(GosFrontline::Backend::Action::CallEngine);
-  logger->log("Logged in Action::CallEngine.");
+  enqueue(CallEngineAction{ready});
+  logger->logf(MessageType::INFO, "Logged in Action::CallEngine.");
   return ready_future;
 }
 
@@ -281,365 +465,450 @@ std::future<void> GosFrontline::Backend::save(std::string filename)
 {
   auto ready = std::make_shared<std::promise<void>>();
   auto ready_future = ready->get_future();
-  todo_save.push(std::make_pair(std::filesystem::path(filename), ready));
-  todo.push(Action::Save);
-  logger->log("Logged in Action::Save.");
+  enqueue(SaveAction{std::filesystem::path(filename), ready});
+  logger->logf(MessageType::INFO, "Logged in Action::Save.");
   return ready_future;
 }
 
 void GosFrontline::Backend::quit()
 {
-  todo.push(Action::Quit);
-  logger->log("Logged in Action::Quit.");
+  enqueue(QuitAction{});
+  logger->logf(MessageType::INFO, "Logged in Action::Quit.");
 }
 
 void GosFrontline::Backend::reverseSides()
 {
-  todo.push(Action::ReverseSides);
-  logger->log("Logged in Action::ReverseSides.");
+  enqueue(ReverseSidesAction{});
+  logger->logf(MessageType::INFO, "Logged in Action::ReverseSides.");
 }
 
-void GosFrontline::Backend::boardSaver(std::filesystem::path p)
+GosFrontline::Gaming GosFrontline::Backend::boardLoader(std::filesystem::path filename, std::optional<size_t> entry)
 {
-  std::ofstream out(p, std::ios::out | std::ios::trunc);
-  if (not out.is_open())
-  {
-    logger->log("Failed to open file for saving. Giving up save.", MessageType::WARNING);
-    return;
-  } // Silent fail
-  auto board_future = getGame();
-  auto result = board_future.wait_for(std::chrono::seconds(60));
-  if (result == std::future_status::timeout)
+  if (not std::filesystem::exists(filename))
+    throw std::runtime_error("File does not exist.");
+
+  // Archives are read through their index; only the chosen game's record is touched.
+  Gaming loaded;
+  if (entry or filename.extension() == GameArchive::extension)
   {
-    logger->log("Failed to get board from backend. Giving up save.", MessageType::WARNING);
-    return;
-  }
-  auto now_game = board_future.get();
-  std::string sente = now_game.getSenteName(), gote = now_game.getGoteName();
-  auto board = now_game.getBoard();
-  auto sequence = now_game.getSequence();
-  auto engine_status = now_game.engineSide();
-  logger->log("Acquired adequate resources. Saving board to file.", MessageType::INFO);
-  out << "Sente: " << sente << "\nGote: " << gote << "\n";
-  out << "Time: " << std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count() << "\n";
-  out << "Engine Status: " << ((engine_status == PieceType::None) ? ("Disabled") : (((engine_status == PieceType::Sente) ? ("Sente") : ("Gote"))))
-      << std::endl;
-  out << "Board Parameters: " << now_game.row_count() << "*" << now_game.col_count() << std::endl;
-
-  for (auto &&row : board)
-  {
-    for (auto &&item : row)
-    {
-      switch (item)
-      {
-      case GosFrontline::PieceType::Sente:
-        out << "@";
-        break;
-      case GosFrontline::PieceType::Gote:
-        out << "O";
-        break;
-      case GosFrontline::PieceType::None:
-      default:
-        out << " ";
-        break;
-      }
-    }
-    out << std::endl;
+    GameArchive archive(filename);
+    if (archive.size() == 0 or (entry and *entry >= archive.size()))
+      throw std::runtime_error("No such game in archive.");
+    loaded = archive.load(entry ? *entry : archive.size() - 1);
   }
-  for (auto &&entry : sequence)
+  else
   {
-    out << std::get<0>(entry) << ' ' << std::get<1>(entry) << ' ' << ((std::get<2>(entry) == PieceType::Sente) ? ("Sente") : ("Gote")) << std::endl;
+    // One read for the whole file; binary saves are recognised by their magic bytes whatever the extension.
+    std::string result(std::filesystem::file_size(filename), '\0');
+    std::ifstream in(filename, std::ios::in | std::ios::binary);
+    if (not in.read(result.data(), static_cast<std::streamsize>(result.size())))
+      throw std::runtime_error("Could not read file.");
+    if (MoveJournal::detect(result))
+      loaded = MoveJournal::decode(result);
+    else
+      loaded = BinarySave::detect(result) ? BinarySave::decode(result) : TextSave::decode(result);
   }
-  logger->log("Saved board to file. Saving thread now exiting.", MessageType::INFO);
-  return;
+
+  // The decoders only check that moves and board agree; replay them to make sure the game was playable.
+  ReplayReport report = ReplayVerifier::verify(loaded);
+  if (not report.ok())
+    throw std::runtime_error("Invalid game: " + report.describe() + ". Please check the file.");
+  return loaded;
 }
 
-GosFrontline::Gaming GosFrontline::Backend::boardLoader(std::filesystem::path filename)
+bool GosFrontline::Backend::handle(MoveHumanAction &move)
 {
-  if (not std::filesystem::exists(filename))
-    throw std::runtime_error("File does not exist.");
-  std::string result = GosFrontline::read_entire_file(filename.string()); // The entire file.
-
-  // Regexes used for matching
-  std::smatch match_cache;
-  std::regex sente_r(R"(Sente:\s*(.*))");
-  std::regex gote_r(R"(^Gote:\s*(.*)$)", std::regex_constants::ECMAScript | std::regex_constants::multiline);
-  std::regex engine_r(R"(Engine Status:\s*(Sente|Gote|Disabled))");
-  std::regex board_params_r(R"(^Board Parameters:\s*(\d+)\*(\d+)$)", std::regex_constants::ECMAScript | std::regex_constants::multiline);
-
-  std::regex_search(result, match_cache, gote_r);
-  std::string gote = match_cache[1];
-  std::regex_search(result, match_cache, sente_r);
-  std::string sente = match_cache[1];
-  std::regex_search(result, match_cache, engine_r);
-  GosFrontline::PieceType
-      engine_status =
-          (match_cache[1] == "Disabled")
-              ? (GosFrontline::PieceType::None)
-              : (((match_cache[1] == "Sente")
-                      ? (GosFrontline::PieceType::Sente)
-                      : (GosFrontline::PieceType::Gote)));
-  int rows, cols;
-  std::regex_search(result, match_cache, board_params_r);
-  try
+  std::lock_guard<std::recursive_mutex> lock(game_mutex);
+  auto begin = std::chrono::steady_clock::now();
+  auto reply = registerHumanMove(move.row, move.col);
+  logger->logf(MessageType::DEBUG, LogFields::move(move.row, move.col).took(std::chrono::steady_clock::now() - begin),
+               "Registered human move, reply {} at step {}", reply.first, reply.second);
+  move.reply->set_value(reply);
+  return true;
+}
+
+bool GosFrontline::Backend::handle(MoveEngineAction &move)
+{
+  auto reply = registerEngineMove(move.row, move.col);
+  if (reply.first != MoveReply::Success)
   {
-    rows = std::stoi(match_cache[1]);
-    cols = std::stoi(match_cache[2]);
+    engine_log->logf(MessageType::ERROR, "Engine Made Bad Move.");
   }
-  catch (std::invalid_argument &e)
+  else
   {
-    throw std::runtime_error("Invalid board parameters.");
+    engine_log->logf(MessageType::INFO, "Engine Made Good Move.");
+    move.reply->set_value();
   }
+  logger->logf(MessageType::ERROR, "This api is deprecated due to sequencial concerns. Control stream should not naturally come here.");
+  return true;
+}
 
-  std::stringstream regex_processor("");
-  regex_processor << "^(?:[ @O]){" << cols << "}$";
-  // std::string reg = regex_processor.str();
-  std::regex board_r(regex_processor.str(), std::regex_constants::ECMAScript | std::regex_constants::multiline),
-      move_r(R"((\d+)\s+(\d+)\s+(Sente|Gote)\s*\n)");
+bool GosFrontline::Backend::handle(SetEngineStatusOffAction &)
+{
+  game.setEngineStatus(PieceType::None);
+  journal.engine(game.engineSide());
+  return true;
+}
 
-  auto board_begin = std::sregex_iterator(result.begin(), result.end(), board_r);
-  auto board_end = std::sregex_iterator();
+bool GosFrontline::Backend::handle(ReverseSidesAction &)
+{
+  game.setEngineStatus(Opposite(game.engineSide()));
+  journal.engine(game.engineSide());
+  return true;
+}
 
-  std::vector<std::vector<GosFrontline::PieceType>> board(rows, std::vector<GosFrontline::PieceType>(cols, GosFrontline::PieceType::None));
+bool GosFrontline::Backend::handle(NewGameAction &params)
+{
+  logger->logf(MessageType::INFO, "New Game Requested with parameters ({}, {})", params.rows, params.cols);
+  game.clearBoard(params.rows, params.cols);
+  gameReset();
+  return true;
+}
 
-  int row = 0;
-  int stone_count = 0;
-  for (std::sregex_iterator i = board_begin; i != board_end && row < rows; ++i, ++row)
+/// @brief The snapshot of the game as it is now, built if the game has changed since the last one.
+const GosFrontline::SnapshotPtr &GosFrontline::Backend::currentSnapshot()
+{
+  std::lock_guard<std::recursive_mutex> lock(game_mutex);
+  if (not snapshot)
   {
-    std::string line = (*i)[0].str();
-    for (int col = 0; col < cols && col < line.size(); ++col)
-    {
-      char ch = line[col];
-      if (ch == ' ')
-        continue;
-      else if (ch == '@')
-        board[row][col] = GosFrontline::PieceType::Sente;
-      else if (ch == 'O')
-        board[row][col] = GosFrontline::PieceType::Gote;
-      stone_count++;
-    }
+    metrics.snapshot_misses.fetch_add(1, std::memory_order_relaxed);
+    logger->logf(MessageType::DEBUG, "Publishing snapshot {} of the game.", version);
+    snapshot = std::make_shared<const GameSnapshot>(GameSnapshot{game, version, delta_sequence});
   }
+  else
+  {
+    metrics.snapshot_hits.fetch_add(1, std::memory_order_relaxed);
+  }
+  return snapshot;
+}
 
-  std::vector<std::tuple<int, int, GosFrontline::PieceType>> sequence;
-  auto move_begin = std::sregex_iterator(result.begin(), result.end(), move_r);
-  auto move_end = std::sregex_iterator();
+/// @brief Every GetBoard/GetGame in a batch gets the same snapshot pointer until a command changes the game,
+///        so coalesced readers share one copy of the board instead of one each.
+bool GosFrontline::Backend::handle(GetBoardAction &request)
+{
+  request.reply->set_value(currentSnapshot());
+  return true;
+}
+
+bool GosFrontline::Backend::handle(GetGameAction &request)
+{
+  request.reply->set_value(currentSnapshot());
+  return true;
+}
 
-  for (std::sregex_iterator i = move_begin; i != move_end; ++i)
+/// @brief Hands the current snapshot to the save writer and returns; the reply is fulfilled once the
+///        file is on disk, or carries the error if it could not be written.
+bool GosFrontline::Backend::handle(SaveAction &request)
+{
+  const SnapshotPtr &current = currentSnapshot();
+  saver.submit(request.path, std::shared_ptr<const Gaming>(current, &current->game),
+               [this, path = request.path, reply = request.reply](const std::string &error, auto elapsed, auto writing)
+               {
+                 metrics.total[command_kinds].record(elapsed);
+                 metrics.service[command_kinds].record(writing);
+                 if (error.empty())
+                 {
+                   io_log->logf(MessageType::INFO, LogFields().took(writing), "Saved game to {}.", path.string());
+                   reply->set_value();
+                 }
+                 else
+                 {
+                   io_log->logf(MessageType::WARNING, "Could not save to {}: {}", path.string(), error);
+                   reply->set_exception(std::make_exception_ptr(std::runtime_error(error)));
+                 }
+               });
+  return true;
+}
+
+bool GosFrontline::Backend::handle(LoadGameAction &request)
+{
+  try
   {
-    int x = std::stoi((*i)[1].str());
-    int y = std::stoi((*i)[2].str());
-    sequence.push_back(std::make_tuple(x, y, (((*i)[3].str() == "Sente") ? (GosFrontline::PieceType::Sente) : (GosFrontline::PieceType::Gote))));
+    game = boardLoader(request.path, request.entry);
   }
+  catch (std::runtime_error &e)
+  {
+    request.reply->set_value(false);
+    io_log->logf(MessageType::INFO, "Failed to load game.");
+    io_log->logf(MessageType::ERROR, "{}", e.what());
+    return true;
+  }
+  gameReset();
+  if (game.toMove() == game.engineSide())
+  {
+    scheduleNext(CallEngineAction{});
+  }
+
+  request.reply->set_value(true);
+  return true;
+}
 
-  // Verify Validity of board
-  if (stone_count != sequence.size())
+bool GosFrontline::Backend::handle(CallEngineAction &request)
+{
+  engine_log->logf(MessageType::INFO, "Calling Engine.");
+  MCTS engine;
+  engine.setInfoCallback([this](const SearchInfo &info)
+                         {
+                           MessageType type = info.final ? MessageType::INFO : MessageType::DEBUG;
+                           if (engine_log->enabled(type))
+                             engine_log->logf(type, LogFields().took(info.time), "{}", info.toString());
+                           search_info.push(info); });
+  auto randmove = engine.getRandomMove(game);
+  game.makeMoveEngine(randmove.first, randmove.second);
+  movePlaced(randmove.first, randmove.second);
+  engine_log->logf(MessageType::INFO, LogFields::move(randmove.first, randmove.second), "Engine has decided on move.");
+  if (request.reply)
   {
-    throw std::runtime_error("Invalid board: Moving sequence did not agree with board on stone count. Please check the file.");
+    request.reply->set_value(true);
   }
+  return true;
+}
 
-  for (auto &&entry : sequence)
+bool GosFrontline::Backend::handle(UndoAction &request)
+{
+  logger->logf(MessageType::INFO, "Undo Requested");
+  auto before = game.getSequence();
+  auto status = game.undo();
+  movesUndone({before.begin() + game.movesMade(), before.end()});
+  if ((not status) and (game.toMove() == game.engineSide()))
   {
-    if (board[std::get<0>(entry)][std::get<1>(entry)] != std::get<2>(entry))
-    {
-      log_stream.str("");
-      log_stream << "Invalid board: Moving sequence did not agree with board on stone type at "
-                 << std::get<0>(entry) << ", " << std::get<1>(entry) << ". Please check the file.";
-      std::string error_msg = log_stream.str();
-      log_stream.str("");
-      throw std::runtime_error(error_msg);
-    }
+    scheduleNext(CallEngineAction{});
+    logger->logf(MessageType::INFO, "Engine must do first move. Pushed in Action::CallEngine.");
   }
 
-  // Create the game object and return
-  return GosFrontline::Gaming(rows, cols, board, sequence, sente, gote, engine_status);
+  request.reply->set_value(true);
+  return true;
+}
+
+bool GosFrontline::Backend::handle(QuitAction &)
+{
+  logger->logf(MessageType::INFO, "Quitting");
+  saver.flush();
+  journal.flush(); // The journal is kept, so the game can be resumed next time
+  if (not journal.error().empty())
+    io_log->logf(MessageType::WARNING, "Autosave journal stopped: {}", journal.error());
+  dumpStats();
+  return false;
 }
 
 int GosFrontline::Backend::run()
 {
   game.clearBoard();
 
-  log_stream.str("");
-  log_stream << "Backend initiated. Running on thread " << std::this_thread::get_id() << ".";
-  logger->log(log_stream.str());
-  log_stream.str("");
+  logger->logf(MessageType::INFO, LogFields().onThisThread(), "Backend initiated.");
 
   while (true)
   {
-    if (todo.empty())
+    // Wait for commands, but no longer than the next stats dump is due, so an idle backend still reports.
+    size_t before = pending.size();
+    auto interval = std::chrono::steady_clock::duration(stats_interval.load(std::memory_order_relaxed));
+    if (interval.count() <= 0)
+      todo.pop_all(pending);
+    else if (not todo.pop_all_for(pending, last_stats_dump + interval - std::chrono::steady_clock::now()))
     {
-      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      dumpStats();
       continue;
     }
+    size_t batch = pending.size() - before;
+    metrics.batches.fetch_add(1, std::memory_order_relaxed);
+    if (batch > metrics.max_batch.load(std::memory_order_relaxed))
+      metrics.max_batch.store(batch, std::memory_order_relaxed);
 
-    Action action = todo.pop();
-    switch (action)
+    std::lock_guard<std::recursive_mutex> lock(game_mutex);
+    while (not pending.empty())
     {
-    case Action::MoveHuman:
-    {
-      std::lock_guard<std::recursive_mutex> lock(game_mutex);
-      std::tuple<int, int, std::shared_ptr<std::promise<std::pair<GosFrontline::MoveReply, int>>>> move = todo_move_human.pop();
-      log_stream.str("");
-      log_stream << "Trying to register human move (" << std::get<0>(move) << ", " << std::get<1>(move) << ")";
-      log_stream.str("");
-
-      std::get<2>(move)->set_value(registerHumanMove(std::get<0>(move), std::get<1>(move)));
-      break;
-    }
-    case Action::MoveEngine:
-    {
-      std::tuple<int, int, PromiseWrapper<void>> move = todo_move_engine.pop();
-      auto reply = registerEngineMove(std::get<0>(move), std::get<1>(move));
-      if (reply.first != MoveReply::Success)
+      QueuedCommand queued = std::move(pending.front());
+      pending.pop_front();
+      Command &command = queued.command;
+      size_t kind = command.index();
+
+      // Anything but a read may change the game, so cached replies are dropped first.
+      if (not(std::holds_alternative<GetBoardAction>(command) or std::holds_alternative<GetGameAction>(command) or
+              std::holds_alternative<SaveAction>(command)))
       {
-        logger->log("Engine Made Bad Move.", MessageType::ERROR);
+        snapshot.reset();
+        version++;
       }
-      else
+
+      auto begin = std::chrono::steady_clock::now();
+      bool running = std::visit([this](auto &action)
+                                { return handle(action); },
+                                command);
+      auto end = std::chrono::steady_clock::now();
+      metrics.service[kind].record(end - begin);
+      metrics.total[kind].record(end - queued.enqueued);
+      if (not queued.internal)
+        metrics.queue_depth.fetch_sub(1, std::memory_order_relaxed);
+      if (not running)
       {
-        logger->log("Engine Made Good Move.", MessageType::INFO);
-        std::get<2>(move)->set_value();
+        return 0;
       }
-      logger->log("This api is deprecated due to sequencial concerns. Control stream should not naturally come here.", MessageType::ERROR);
-      break;
-    }
-    case Action::SetEngineStatusOff:
-    {
-      game.setEngineStatus(PieceType::None);
-      break;
     }
-    case Action::ReverseSides:
-    {
-      game.setEngineStatus(Opposite(game.engineSide()));
-      break;
-    }
-    case Action::NewGame:
-    {
-      logger->log(std::string("New Game Requested with parameters (") + std::to_string(rows) +
-                  std::string(", ") + std::to_string(cols) + std::string(")"));
-      game.clearBoard(rows, cols);
-      break;
-    }
-    case Action::GetBoard:
+
+    interval = std::chrono::steady_clock::duration(stats_interval.load(std::memory_order_relaxed));
+    if (interval.count() > 0 and std::chrono::steady_clock::now() - last_stats_dump >= interval)
     {
-      std::unique_lock<std::recursive_mutex> lock(game_mutex);
-      std::shared_ptr<std::promise<GosFrontline::Backend::BoardAndStep>> board = boards.pop();
-      logger->log("Preparing the board.");
-      board->set_value(std::make_pair(game.getBoard(), game.movesMade()));
-      lock.unlock();
-      break;
+      dumpStats();
     }
-    case Action::GetGame:
+  }
+}
+
+/// @brief Queue @p command for the backend thread, stamped so its latency can be measured.
+void GosFrontline::Backend::enqueue(Command &&command)
+{
+  size_t depth = metrics.queue_depth.fetch_add(1, std::memory_order_relaxed) + 1;
+  size_t deepest = metrics.max_queue_depth.load(std::memory_order_relaxed);
+  while (depth > deepest and not metrics.max_queue_depth.compare_exchange_weak(deepest, depth, std::memory_order_relaxed))
+  {
+  }
+  todo.push(QueuedCommand{std::move(command), std::chrono::steady_clock::now()});
+}
+
+/// @brief Run @p command before anything else still waiting in the current batch or queue.
+/// @note Only call this from the backend thread.
+void GosFrontline::Backend::scheduleNext(Command command)
+{
+  pending.push_front(QueuedCommand{std::move(command), std::chrono::steady_clock::now(), true});
+}
+
+/// @brief Next engine search report, oldest first, without waiting. Only the latest
+///        search_info_backlog reports are kept for a front end that does not keep up.
+/// @return std::nullopt once the front end has seen every report.
+std::optional<GosFrontline::SearchInfo> GosFrontline::Backend::nextSearchInfo()
+{
+  return search_info.try_pop();
+}
+
+/// @brief Stream every later change to the game to the returned subscription, which keeps at most
+///        @p backlog deltas for a slow reader. Safe from any thread; drop the pointer to unsubscribe.
+std::shared_ptr<GosFrontline::DeltaSubscription> GosFrontline::Backend::subscribe(size_t backlog)
+{
+  auto subscription = std::make_shared<DeltaSubscription>(backlog);
+  std::lock_guard<std::mutex> lock(subscribers_mutex);
+  subscribers.push_back(subscription);
+  return subscription;
+}
+
+/// @brief Number @p delta and hand it to every live subscriber, forgetting the ones that are gone.
+void GosFrontline::Backend::publish(GameDelta delta)
+{
+  delta.sequence = ++delta_sequence;
+  std::lock_guard<std::mutex> lock(subscribers_mutex);
+  for (size_t i = 0; i < subscribers.size();)
+  {
+    if (auto subscription = subscribers[i].lock())
     {
-      std::unique_lock<std::recursive_mutex> lock(game_mutex);
-      std::shared_ptr<std::promise<GosFrontline::Gaming>> board = game_copies.pop();
-      logger->log("Preparing the copy of the game.");
-      board->set_value(game);
-      lock.unlock();
-      break;
+      subscription->deltas.push(delta);
+      i++;
     }
-    case Action::Save:
+    else
     {
-      auto save_info = todo_save.pop();
-      std::thread([this, save_info]()
-                  { boardSaver(save_info.first); })
-          .detach();
-      save_info.second->set_value();
-      break;
+      subscribers[i] = std::move(subscribers.back());
+      subscribers.pop_back();
     }
-    case Action::LoadGame:
-    {
-      auto thisPromise = todo_load.pop();
-      try
-      {
-        game = boardLoader(thisPromise.first.string());
-      }
-      catch (std::runtime_error &e)
-      {
-        thisPromise.second->set_value(false);
-        logger->log("Failed to load game.");
-        logger->log(e.what(), MessageType::ERROR);
-        break;
-      }
-      if (game.toMove() == game.engineSide())
-      {
-        todo._push_front(Action::CallEngine);
-      }
+  }
+}
 
-      thisPromise.second->set_value(true);
-      break;
-    }
-    case Action::CallEngine:
-    {
-      logger->log("Calling Engine.", MessageType::INFO);
-      auto thisPromise = todo_actions.pop();
-      SafeQueue<decltype(thisPromise)> promises_cache;
+// Every change to the game goes through one of these, so the journal and the subscribers see the same history.
 
-      while (thisPromise.first != Action::CallEngine)
-      {
-        if (todo_actions.empty())
-        {
-          logger->log("Engine move promise lost. Throwing.", MessageType::FATAL);
-          throw std::runtime_error("Engine move promise lost.");
-        }
-        thisPromise = todo_actions.pop();
-      }
-      while (not promises_cache.empty())
-      {
-        auto temp = promises_cache.pop();
-        todo_actions.push(temp);
-      }
-      logger->log("Engine move promise found.", MessageType::INFO);
-      auto randmove = MCTS().getRandomMove(game);
-      game.makeMoveEngine(randmove.first, randmove.second);
-      logger->log("Engine has decided on move.");
-      break;
-    }
-    case Action::Undo:
-    {
-      logger->log("Undo Requested");
-      auto status = game.undo();
-      if ((not status) and (game.toMove() == game.engineSide()))
-      {
-        todo._push_front(Action::CallEngine);
-        PromiseWrapper<bool> promise;
-        todo_actions.push(std::make_pair(Action::CallEngine, promise));
-        logger->log("Engine must do first move. Pushed in Action::CallEngine.");
-      }
+void GosFrontline::Backend::movePlaced(int row, int col)
+{
+  journal.move(row, col);
+  PieceType side = std::get<2>(game.getSequence().back());
+  publish(GameDelta{GameDelta::Kind::Placed, 0, row, col, side});
+  PieceType winner = game.checkCurrentWin(row, col);
+  if (winner != PieceType::None)
+    publish(GameDelta{GameDelta::Kind::Result, 0, row, col, winner});
+}
 
-      auto thisPromise = todo_actions.pop();
-      SafeQueue<decltype(thisPromise)> promises_cache;
-      while (thisPromise.first != Action::Undo)
-      {
-        promises_cache.push(thisPromise);
-        if (todo_actions.empty())
-        {
-          logger->log("Undo promise lost. Throwing.", MessageType::FATAL);
-          throw std::runtime_error("Engine move promise lost.");
-        }
-        thisPromise = todo_actions.pop();
-      }
-      logger->log("Undo promise found.");
-      while (not promises_cache.empty())
-      {
-        auto temp = promises_cache.pop();
-        todo_actions.push(temp);
-      }
+/// @param removed The moves taken back, oldest first.
+void GosFrontline::Backend::movesUndone(const std::vector<std::tuple<int, int, PieceType>> &removed)
+{
+  journal.undo(static_cast<int>(removed.size()));
+  for (auto move = removed.rbegin(); move != removed.rend(); ++move)
+    publish(GameDelta{GameDelta::Kind::Undone, 0, std::get<0>(*move), std::get<1>(*move), std::get<2>(*move)});
+}
 
-      thisPromise.second->set_value(true);
-      break;
-    }
-    case Action::Quit:
-    {
-      logger->log("Quitting", MessageType::INFO);
-      // TODO: Autosave Current game as <autosave>
-      return 0;
-    }
-    }
+/// @brief A new or loaded game replaces the old one: restart the journal and replay the board to subscribers.
+void GosFrontline::Backend::gameReset()
+{
+  journal.restart(game);
+  GameDelta reset{GameDelta::Kind::Reset};
+  reset.rows = static_cast<int>(game.row_count());
+  reset.cols = static_cast<int>(game.col_count());
+  publish(reset);
+  for (const auto &[row, col, side] : game.getSequence())
+    publish(GameDelta{GameDelta::Kind::Placed, 0, row, col, side});
+  if (not game.getSequence().empty())
+  {
+    auto [row, col, side] = game.getSequence().back();
+    PieceType winner = game.checkCurrentWin(row, col);
+    if (winner != PieceType::None)
+      publish(GameDelta{GameDelta::Kind::Result, 0, row, col, winner});
+  }
+}
+
+/// @brief Latency, queue and cache figures since the backend was created. Safe from any thread.
+GosFrontline::BackendStats GosFrontline::Backend::getStats() const
+{
+  BackendStats stats;
+  for (size_t kind = 0; kind < action_names.size(); kind++)
+  {
+    LatencySummary total = metrics.total[kind].summary();
+    if (total.count == 0)
+      continue;
+    stats.actions.push_back(BackendStats::Action{action_names[kind], total, metrics.service[kind].summary()});
   }
+  stats.queue_depth = metrics.queue_depth.load(std::memory_order_relaxed);
+  stats.max_queue_depth = metrics.max_queue_depth.load(std::memory_order_relaxed);
+  stats.batches = metrics.batches.load(std::memory_order_relaxed);
+  stats.max_batch = metrics.max_batch.load(std::memory_order_relaxed);
+  stats.snapshot_hits = metrics.snapshot_hits.load(std::memory_order_relaxed);
+  stats.snapshot_misses = metrics.snapshot_misses.load(std::memory_order_relaxed);
+  stats.journal_records = journal.records();
+  stats.journal_commits = journal.commits();
+  stats.uptime = std::chrono::steady_clock::now() - metrics.started;
+  return stats;
+}
+
+/// @brief How often the run loop writes getStats() to the "Metrics" log channel. 0 turns it off;
+///        the figures are still written once on quit.
+void GosFrontline::Backend::setStatsInterval(std::chrono::seconds interval)
+{
+  stats_interval.store(std::chrono::steady_clock::duration(interval).count(), std::memory_order_relaxed);
+}
+
+void GosFrontline::Backend::dumpStats()
+{
+  last_stats_dump = std::chrono::steady_clock::now();
+  if (not metrics_log)
+    return;
+  BackendStats stats = getStats();
+  metrics_log->logf(MessageType::INFO, "Queue depth {} (max {}), {} batches (max {}), snapshot hits {} / misses {}, journal {} records in {} commits",
+                    stats.queue_depth, stats.max_queue_depth, stats.batches, stats.max_batch,
+                    stats.snapshot_hits, stats.snapshot_misses, stats.journal_records, stats.journal_commits);
+  for (const auto &action : stats.actions)
+  {
+    metrics_log->logf(MessageType::INFO, "{} n={} total_us p50={} p99={} p999={} max={} service_us p50={} p99={}",
+                      action.name, action.total.count, action.total.p50_ns / 1000, action.total.p99_ns / 1000,
+                      action.total.p999_ns / 1000, action.total.max_ns / 1000,
+                      action.service.p50_ns / 1000, action.service.p99_ns / 1000);
+  }
+}
+
+/// @brief Journal the game in progress to @p path, starting with the next new or loaded game.
+///        A journal left by a crash can be read back with loadGame(path) until then.
+void GosFrontline::Backend::setJournal(std::filesystem::path path)
+{
+  journal.open(path);
 }
 
 void GosFrontline::Backend::setLogger(std::shared_ptr<GosFrontline::Logger> lg)
 {
   this->logger = lg;
+  this->engine_log = lg->channel("Engine");
+  this->io_log = lg->channel("IO");
+  this->metrics_log = lg->channel("Metrics");
 }
 
 #endif // BACKEND_H
\ No newline at end of file
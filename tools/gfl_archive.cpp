@@ -0,0 +1,122 @@
+// Packs saved games into a .gfla archive, lists an archive from its index, and extracts single games.
+//
+// Build from the repository root:
+//   g++ -std=c++17 -O2 tools/gfl_archive.cpp -o gfl_archive
+// Usage:
+//   ./gfl_archive pack <archive.gfla> <save or directory> [more ...]   (appends; .gfl and .gflb inputs)
+//   ./gfl_archive list <archive.gfla>
+//   ./gfl_archive extract <archive.gfla> <game number> <out.gfl|out.gflb>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../src/GameArchive.h"
+
+namespace
+{
+  using namespace GosFrontline;
+
+  Gaming loadSave(const std::filesystem::path &path)
+  {
+    std::string data(std::filesystem::file_size(path), '\0');
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    if (not in.read(data.data(), static_cast<std::streamsize>(data.size())))
+      throw std::runtime_error("Could not read file.");
+    return BinarySave::detect(data) ? BinarySave::decode(data) : TextSave::decode(data);
+  }
+
+  int pack(const std::filesystem::path &archive, const std::vector<std::filesystem::path> &inputs)
+  {
+    std::vector<std::filesystem::path> files;
+    for (const auto &input : inputs)
+    {
+      if (std::filesystem::is_directory(input))
+      {
+        for (const auto &entry : std::filesystem::directory_iterator(input))
+        {
+          auto extension = entry.path().extension();
+          if (extension == ".gfl" or extension == BinarySave::extension)
+            files.push_back(entry.path());
+        }
+      }
+      else
+      {
+        files.push_back(input);
+      }
+    }
+
+    int status = 0;
+    GameArchive::Writer writer(archive);
+    size_t before = writer.size();
+    for (const auto &file : files)
+    {
+      try
+      {
+        writer.add(loadSave(file));
+      }
+      catch (std::exception &e)
+      {
+        std::cerr << file.string() << ": " << e.what() << std::endl;
+        status = 1;
+      }
+    }
+    writer.close();
+    std::cout << "Added " << writer.size() - before << " game(s); " << archive.string() << " now holds " << writer.size() << "." << std::endl;
+    return status;
+  }
+
+  int list(const std::filesystem::path &path)
+  {
+    const char *results[] = {"unfinished", "Sente won", "Gote won", "draw"};
+    GameArchive archive(path);
+    for (size_t i = 0; i < archive.size(); i++)
+    {
+      const ArchiveEntry &e = archive.entry(i);
+      std::cout << i + 1 << '\t' << e.sente << " vs " << e.gote << '\t' << e.moves << " moves\t"
+                << results[static_cast<int>(e.result) & 3] << '\t' << std::hex << e.hash << std::dec << std::endl;
+    }
+    return 0;
+  }
+
+  int extract(const std::filesystem::path &path, size_t number, const std::filesystem::path &out_path)
+  {
+    GameArchive archive(path);
+    if (number < 1 or number > archive.size())
+    {
+      std::cerr << "The archive holds games 1 to " << archive.size() << "." << std::endl;
+      return 1;
+    }
+    std::string data = out_path.extension() == BinarySave::extension ? archive.record(number - 1) : TextSave::encode(archive.load(number - 1));
+    std::ofstream out(out_path, std::ios::out | std::ios::trunc | std::ios::binary);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return out ? 0 : 1;
+  }
+} // namespace
+
+int main(int argc, char **argv)
+{
+  std::string command = argc > 2 ? argv[1] : "";
+  try
+  {
+    if (command == "pack" and argc > 3)
+      return pack(argv[2], std::vector<std::filesystem::path>(argv + 3, argv + argc));
+    if (command == "list" and argc == 3)
+      return list(argv[2]);
+    if (command == "extract" and argc == 5)
+      return extract(argv[2], static_cast<size_t>(std::strtoul(argv[3], nullptr, 10)), argv[4]);
+  }
+  catch (std::exception &e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  std::cerr << "Usage: " << argv[0] << " pack <archive.gfla> <save or directory> [more ...]\n"
+            << "       " << argv[0] << " list <archive.gfla>\n"
+            << "       " << argv[0] << " extract <archive.gfla> <game number> <out.gfl|out.gflb>" << std::endl;
+  return 2;
+}
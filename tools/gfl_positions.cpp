@@ -0,0 +1,102 @@
+// Builds and queries position indexes (.gfpi) over game archives (.gfla).
+//
+// Build from the repository root:
+//   g++ -std=c++17 -O2 -pthread tools/gfl_positions.cpp -o gfl_positions
+// Usage:
+//   ./gfl_positions build <archive.gfla> [--threads <n>]          (writes <archive>.gfpi next to it)
+//   ./gfl_positions query <archive.gfla> <save.gfl|save.gflb> [--ply <n>]
+// A query looks up the position of the save after its last move, or after --ply moves.
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "../src/PositionIndex.h"
+
+namespace
+{
+  using namespace GosFrontline;
+  using Clock = std::chrono::steady_clock;
+
+  std::filesystem::path indexPath(std::filesystem::path archive)
+  {
+    return archive.replace_extension(PositionIndex::extension);
+  }
+
+  int build(const std::filesystem::path &archive, unsigned threads)
+  {
+    auto begin = Clock::now();
+    GameDatabase db(archive);
+    size_t positions = PositionIndex::build(db, indexPath(archive), threads);
+    std::cout << "Indexed " << positions << " positions from " << db.size() << " games into " << indexPath(archive).string()
+              << " in " << std::fixed << std::setprecision(2) << std::chrono::duration<double>(Clock::now() - begin).count() << " s." << std::endl;
+    return 0;
+  }
+
+  int query(const std::filesystem::path &archive, const std::filesystem::path &save, int ply)
+  {
+    std::string data(std::filesystem::file_size(save), '\0');
+    std::ifstream in(save, std::ios::in | std::ios::binary);
+    if (not in.read(data.data(), static_cast<std::streamsize>(data.size())))
+      throw std::runtime_error("Could not read " + save.string() + ".");
+    Gaming game = BinarySave::detect(data) ? BinarySave::decode(data) : TextSave::decode(data);
+    const auto &moves = game.getSequence();
+    PositionHasher hasher(static_cast<int>(game.row_count()), static_cast<int>(game.col_count()));
+    for (int i = 0; i < static_cast<int>(moves.size()) and (ply < 0 or i < ply); i++)
+      hasher.add(std::get<0>(moves[i]), std::get<1>(moves[i]), std::get<2>(moves[i]));
+
+    GameDatabase db(archive);
+    PositionIndex index(indexPath(archive));
+    if (not index.matches(db))
+      std::cerr << "Warning: " << archive.string() << " has changed since the index was built." << std::endl;
+    auto begin = Clock::now();
+    auto hits = index.find(hasher.canonical());
+    double micros = std::chrono::duration<double, std::micro>(Clock::now() - begin).count();
+    for (const auto &hit : hits)
+    {
+      if (hit.game >= db.size())
+        continue;
+      const ArchiveEntry &e = db.entries()[hit.game];
+      std::cout << "game " << hit.game + 1 << " (" << e.sente << " vs " << e.gote << "), ply " << hit.ply
+                << ", symmetry " << static_cast<int>(hit.symmetry) << std::endl;
+    }
+    std::cout << hits.size() << " hit(s) among " << index.size() << " positions, " << std::fixed << std::setprecision(1)
+              << micros << " us." << std::endl;
+    return 0;
+  }
+} // namespace
+
+int main(int argc, char **argv)
+{
+  std::string command = argc > 2 ? argv[1] : "";
+  unsigned threads = 0;
+  int ply = -1;
+  for (int i = 3; i + 1 < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--threads") == 0)
+      threads = static_cast<unsigned>(std::atoi(argv[i + 1]));
+    else if (std::strcmp(argv[i], "--ply") == 0)
+      ply = std::atoi(argv[i + 1]);
+  }
+  try
+  {
+    if (command == "build")
+      return build(argv[2], threads);
+    if (command == "query" and argc > 3)
+      return query(argv[2], argv[3], ply);
+  }
+  catch (std::exception &e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  std::cerr << "Usage: " << argv[0] << " build <archive.gfla> [--threads <n>]\n"
+            << "       " << argv[0] << " query <archive.gfla> <save.gfl|save.gflb> [--ply <n>]" << std::endl;
+  return 2;
+}
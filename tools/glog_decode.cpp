@@ -0,0 +1,34 @@
+// Renders binary logs written by Logger::enableBinarySink to the usual text log format.
+//
+// Build from the repository root:
+//   g++ -std=c++17 -O2 tools/glog_decode.cpp -o glog_decode
+// Usage:
+//   ./glog_decode log/Backend_<ms>.glog [more.glog ...] > Backend.txt
+
+#include <iostream>
+#include <stdexcept>
+
+#include "../src/BinaryLog.h"
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " <file.glog> [more.glog ...]" << std::endl;
+    return 2;
+  }
+  int status = 0;
+  for (int i = 1; i < argc; i++)
+  {
+    try
+    {
+      GosFrontline::BinaryLogReader(argv[i]).render(std::cout);
+    }
+    catch (std::runtime_error &e)
+    {
+      std::cerr << e.what() << std::endl;
+      status = 1;
+    }
+  }
+  return status;
+}